@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2024 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "rk_blit_backend.h"
+#include <unistd.h>
+#include "RgaUtils.h"
+#include "RgaApi.h"
+
+namespace OHOS::Camera {
+static constexpr const char* RGA_DEVICE = "/dev/rga";
+
+bool RkRgaBlitBackend::IsAvailable()
+{
+    static const bool available = access(RGA_DEVICE, R_OK | W_OK) == 0;
+    return available;
+}
+
+RetCode RkRgaBlitBackend::Blit(const RkBlitImage& srcImage, const RkBlitImage& dstImage, int32_t rotation)
+{
+    rga_info_t src = {};
+    rga_info_t dst = {};
+
+    src.mmuFlag = 1;
+    src.rotation = rotation;
+    src.fd = srcImage.fd;
+    src.virAddr = srcImage.fd >= 0 ? nullptr : srcImage.virAddr;
+    src.sync_mode = RGA_BLIT_ASYNC;
+
+    dst.mmuFlag = 1;
+    dst.fd = dstImage.fd;
+    dst.virAddr = dstImage.fd >= 0 ? nullptr : dstImage.virAddr;
+
+    rga_set_rect(&src.rect, 0, 0, srcImage.width, srcImage.height,
+        srcImage.width, srcImage.height, srcImage.rkFmt);
+    rga_set_rect(&dst.rect, 0, 0, dstImage.width, dstImage.height,
+        dstImage.width, dstImage.height, dstImage.rkFmt);
+
+    int ret = rga_.RkRgaBlit(&src, &dst, NULL);
+    if (ret != 0) {
+        CAMERA_LOGW("RkRgaBlitBackend::Blit failed, ret = %{public}d", ret);
+        return RC_ERROR;
+    }
+    return RC_OK;
+}
+
+void RkRgaBlitBackend::Flush()
+{
+    rga_.RkRgaFlush();
+}
+} // namespace OHOS::Camera
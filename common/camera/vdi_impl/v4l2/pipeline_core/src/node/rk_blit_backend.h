@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2024 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HOS_CAMERA_RK_BLIT_BACKEND_H
+#define HOS_CAMERA_RK_BLIT_BACKEND_H
+
+#include <cstdint>
+#include "camera.h"
+#include "RockchipRga.h"
+
+namespace OHOS::Camera {
+// An image for a blit. fd is the dma-buf when there is one, virAddr is its CPU mapping (or the memory itself).
+struct RkBlitImage {
+    int fd;
+    void* virAddr;
+    uint32_t width;
+    uint32_t height;
+    int32_t rkFmt;      // RK_FORMAT_*, tightly packed rows
+};
+
+/*
+ * Something that copies, converts, scales and rotates images. Blit may complete asynchronously,
+ * Flush waits for everything queued before it.
+ */
+class RkBlitBackend {
+public:
+    virtual ~RkBlitBackend() = default;
+    virtual const char* GetName() const = 0;
+    // rotation is a HAL_TRANSFORM_ROT_* value or 0
+    virtual RetCode Blit(const RkBlitImage& src, const RkBlitImage& dst, int32_t rotation) = 0;
+    virtual void Flush() = 0;
+};
+
+class RkRgaBlitBackend : public RkBlitBackend {
+public:
+    // false when the RGA device node can not be opened, e.g. on a board without RGA or a host build
+    static bool IsAvailable();
+
+    const char* GetName() const override
+    {
+        return "rga";
+    }
+    RetCode Blit(const RkBlitImage& src, const RkBlitImage& dst, int32_t rotation) override;
+    void Flush() override;
+
+private:
+    RockchipRga rga_;
+};
+} // namespace OHOS::Camera
+#endif
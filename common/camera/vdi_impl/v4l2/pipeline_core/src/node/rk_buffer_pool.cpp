@@ -0,0 +1,256 @@
+/*
+ * Copyright (c) 2024 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "rk_buffer_pool.h"
+#include <algorithm>
+#include <cstdlib>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <linux/dma-buf.h>
+#include <linux/dma-heap.h>
+#include "camera.h"
+
+namespace OHOS::Camera {
+static constexpr size_t POOL_MIN_CLASS = 4096;          // 4096:one page
+static constexpr size_t POOL_CLASS_SPLIT_SHIFT = 2;     // 2:four classes per power of two
+static constexpr size_t POOL_FREE_PER_CLASS = 4;        // 4:free slabs kept per class
+static constexpr size_t POOL_HEAP_ALIGN = 64;           // 64:cache line
+static constexpr const char* DMA_HEAP_DEVICE = "/dev/dma_heap/system";
+
+struct RkPoolSlab {
+    uint8_t* data;
+    size_t size;
+    int fd;
+    RkPoolMemory memory;
+};
+
+static size_t GetClassSize(size_t size)
+{
+    if (size <= POOL_MIN_CLASS) {
+        return POOL_MIN_CLASS;
+    }
+    size_t power = POOL_MIN_CLASS;
+    while (power * 2 < size) { // 2:next power of two
+        power *= 2;            // 2:next power of two
+    }
+    size_t step = power >> POOL_CLASS_SPLIT_SHIFT;
+    return (size + step - 1) / step * step;
+}
+
+static int GetDmaHeapFd()
+{
+    static const int heapFd = [] {
+        int fd = open(DMA_HEAP_DEVICE, O_RDWR | O_CLOEXEC);
+        if (fd < 0) {
+            CAMERA_LOGW("RkBufferPool: %{public}s not available, dma slabs fall back to heap memory",
+                DMA_HEAP_DEVICE);
+        }
+        return fd;
+    }();
+    return heapFd;
+}
+
+static RkPoolSlab* AllocSlab(size_t size, RkPoolMemory memory)
+{
+    int heapFd = memory == RK_POOL_DMA ? GetDmaHeapFd() : -1;
+    if (heapFd >= 0) {
+        struct dma_heap_allocation_data data = {};
+        data.len = size;
+        data.fd_flags = O_RDWR | O_CLOEXEC;
+        if (ioctl(heapFd, DMA_HEAP_IOCTL_ALLOC, &data) == 0) {
+            int fd = static_cast<int>(data.fd);
+            void* addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (addr != MAP_FAILED) {
+                return new RkPoolSlab {static_cast<uint8_t*>(addr), size, fd, memory};
+            }
+            close(fd);
+        }
+        CAMERA_LOGW("RkBufferPool: dma-buf of %{public}zu bytes failed, using heap memory", size);
+    }
+    void* addr = std::aligned_alloc(POOL_HEAP_ALIGN, size);
+    if (addr == nullptr) {
+        CAMERA_LOGE("RkBufferPool: out of memory, %{public}zu bytes", size);
+        return nullptr;
+    }
+    return new RkPoolSlab {static_cast<uint8_t*>(addr), size, -1, memory};
+}
+
+static void FreeSlab(RkPoolSlab* slab)
+{
+    if (slab->fd >= 0) {
+        munmap(slab->data, slab->size);
+        close(slab->fd);
+    } else {
+        std::free(slab->data);
+    }
+    delete slab;
+}
+
+RkPoolBuffer::~RkPoolBuffer()
+{
+    Release();
+}
+
+RkPoolBuffer::RkPoolBuffer(RkPoolBuffer&& other) noexcept : slab_(other.slab_)
+{
+    other.slab_ = nullptr;
+}
+
+RkPoolBuffer& RkPoolBuffer::operator=(RkPoolBuffer&& other) noexcept
+{
+    if (this != &other) {
+        Release();
+        slab_ = other.slab_;
+        other.slab_ = nullptr;
+    }
+    return *this;
+}
+
+uint8_t* RkPoolBuffer::GetData() const
+{
+    return slab_ == nullptr ? nullptr : slab_->data;
+}
+
+size_t RkPoolBuffer::GetSize() const
+{
+    return slab_ == nullptr ? 0 : slab_->size;
+}
+
+int RkPoolBuffer::GetFd() const
+{
+    return slab_ == nullptr ? -1 : slab_->fd;
+}
+
+void RkPoolBuffer::Release()
+{
+    if (slab_ != nullptr) {
+        RkBufferPool::GetInstance().Recycle(slab_);
+        slab_ = nullptr;
+    }
+}
+
+RkBufferPool& RkBufferPool::GetInstance()
+{
+    // never destroyed, static objects of other files may still hand slabs back while the process exits
+    static RkBufferPool* instance = new RkBufferPool();
+    return *instance;
+}
+
+RkPoolBuffer RkBufferPool::Acquire(size_t size, RkPoolMemory memory)
+{
+    RkPoolBuffer buffer;
+    size_t classSize = GetClassSize(size);
+    {
+        std::lock_guard<std::mutex> l(lock_);
+        auto it = free_[memory].find(classSize);
+        if (it != free_[memory].end() && !it->second.empty()) {
+            buffer.slab_ = it->second.back();
+            it->second.pop_back();
+            stats_.hits++;
+            stats_.bytesCached -= classSize;
+            stats_.bytesInUse += classSize;
+            stats_.highWater = std::max(stats_.highWater, stats_.bytesInUse);
+            return buffer;
+        }
+        stats_.misses++;
+    }
+
+    // allocate outside the lock, a dma-buf allocation can take a while
+    buffer.slab_ = AllocSlab(classSize, memory);
+    if (buffer.slab_ != nullptr) {
+        std::lock_guard<std::mutex> l(lock_);
+        stats_.bytesInUse += classSize;
+        stats_.highWater = std::max(stats_.highWater, stats_.bytesInUse);
+    }
+    return buffer;
+}
+
+void RkBufferPool::Reserve(RkPoolBuffer& buffer, size_t size, RkPoolMemory memory)
+{
+    if (buffer.slab_ != nullptr && buffer.slab_->size >= size && buffer.slab_->memory == memory) {
+        return;
+    }
+    buffer.Release();
+    buffer = Acquire(size, memory);
+}
+
+void RkBufferPool::Recycle(RkPoolSlab* slab)
+{
+    std::unique_lock<std::mutex> l(lock_);
+    stats_.bytesInUse -= slab->size;
+    auto& slabs = free_[slab->memory][slab->size];
+    if (slabs.size() < POOL_FREE_PER_CLASS) {
+        slabs.push_back(slab);
+        stats_.bytesCached += slab->size;
+        return;
+    }
+    l.unlock();
+    FreeSlab(slab);
+}
+
+void RkBufferPool::Trim()
+{
+    std::vector<RkPoolSlab*> slabs;
+    {
+        std::lock_guard<std::mutex> l(lock_);
+        for (auto& classes : free_) {
+            for (auto& it : classes) {
+                slabs.insert(slabs.end(), it.second.begin(), it.second.end());
+            }
+            classes.clear();
+        }
+        stats_.bytesCached = 0;
+    }
+    for (auto slab : slabs) {
+        FreeSlab(slab);
+    }
+}
+
+RkPoolStats RkBufferPool::GetStats()
+{
+    std::lock_guard<std::mutex> l(lock_);
+    return stats_;
+}
+
+void RkBufferPool::LogStats(const char* tag)
+{
+    RkPoolStats stats = GetStats();
+    CAMERA_LOGI("%{public}s buffer pool: hits %{public}llu, misses %{public}llu, in use %{public}zu, "
+        "high water %{public}zu, cached %{public}zu bytes", tag, static_cast<unsigned long long>(stats.hits),
+        static_cast<unsigned long long>(stats.misses), stats.bytesInUse, stats.highWater, stats.bytesCached);
+}
+
+static void SyncDmaBuf(int fd, uint64_t flags)
+{
+    if (fd < 0) {
+        return;
+    }
+    struct dma_buf_sync sync = {};
+    sync.flags = flags | DMA_BUF_SYNC_RW;
+    if (ioctl(fd, DMA_BUF_IOCTL_SYNC, &sync) != 0) {
+        CAMERA_LOGD("DMA_BUF_IOCTL_SYNC failed on fd %{public}d", fd);
+    }
+}
+
+void RkDmaBufBeginCpuAccess(int fd)
+{
+    SyncDmaBuf(fd, DMA_BUF_SYNC_START);
+}
+
+void RkDmaBufEndCpuAccess(int fd)
+{
+    SyncDmaBuf(fd, DMA_BUF_SYNC_END);
+}
+} // namespace OHOS::Camera
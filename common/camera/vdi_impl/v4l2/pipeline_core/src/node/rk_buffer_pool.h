@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2024 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HOS_CAMERA_RK_BUFFER_POOL_H
+#define HOS_CAMERA_RK_BUFFER_POOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace OHOS::Camera {
+enum RkPoolMemory : uint32_t {
+    RK_POOL_HEAP = 0,   // CPU only
+    RK_POOL_DMA,        // a dma-buf RGA and MPP can use through its fd, heap memory when there is no dma-heap
+    RK_POOL_MEMORY_COUNT,
+};
+
+struct RkPoolStats {
+    uint64_t hits = 0;          // requests served from a cached slab
+    uint64_t misses = 0;        // requests that had to allocate
+    size_t bytesInUse = 0;
+    size_t highWater = 0;       // largest bytesInUse so far
+    size_t bytesCached = 0;     // free slabs kept for reuse
+};
+
+struct RkPoolSlab;
+
+// A slab borrowed from RkBufferPool, it goes back to the pool when the handle is destroyed.
+class RkPoolBuffer {
+public:
+    RkPoolBuffer() = default;
+    ~RkPoolBuffer();
+    RkPoolBuffer(RkPoolBuffer&& other) noexcept;
+    RkPoolBuffer& operator=(RkPoolBuffer&& other) noexcept;
+    RkPoolBuffer(const RkPoolBuffer&) = delete;
+    RkPoolBuffer& operator=(const RkPoolBuffer&) = delete;
+
+    uint8_t* GetData() const;
+    size_t GetSize() const;     // capacity of the slab, at least the size asked for
+    int GetFd() const;          // -1 unless the slab is a dma-buf
+    void Release();
+
+private:
+    friend class RkBufferPool;
+    RkPoolSlab* slab_ = nullptr;
+};
+
+/*
+ * Size classed cache of intermediate frame memory shared by every node of the pipeline. A request
+ * is rounded up to its class (four classes per power of two, so at most a quarter is wasted) and
+ * served from a free slab of that class when there is one. Once streaming has reached its steady
+ * state every request is a hit and nothing is allocated.
+ */
+class RkBufferPool {
+public:
+    static RkBufferPool& GetInstance();
+
+    RkPoolBuffer Acquire(size_t size, RkPoolMemory memory = RK_POOL_HEAP);
+    // keeps buffer when it already holds size bytes of the right memory, otherwise swaps it for
+    // a larger slab; the contents are not carried over
+    void Reserve(RkPoolBuffer& buffer, size_t size, RkPoolMemory memory = RK_POOL_HEAP);
+    // frees every cached slab
+    void Trim();
+    RkPoolStats GetStats();
+    void LogStats(const char* tag);
+
+private:
+    RkBufferPool() = default;
+    ~RkBufferPool() = default;
+    friend class RkPoolBuffer;
+    void Recycle(RkPoolSlab* slab);
+
+    std::mutex lock_;
+    std::map<size_t, std::vector<RkPoolSlab*>> free_[RK_POOL_MEMORY_COUNT];
+    RkPoolStats stats_;
+};
+
+// brackets CPU access to a dma-buf so caches are kept coherent with RGA and MPP, no-op for fd < 0
+void RkDmaBufBeginCpuAccess(int fd);
+void RkDmaBufEndCpuAccess(int fd);
+} // namespace OHOS::Camera
+#endif
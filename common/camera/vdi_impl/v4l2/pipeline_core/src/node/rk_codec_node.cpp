@@ -0,0 +1,1035 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "rk_codec_node.h"
+#include "rk_node_utils.h"
+#include "rk_soc_caps.h"
+#include "rk_dump_writer.h"
+#include "rk_exif_template.h"
+#include "rk_format_negotiator.h"
+#include "rk_jpeg_strips.h"
+#include "rk_trace.h"
+#include "rk_transform_planner.h"
+#include "rk_vendor_tags.h"
+#include <algorithm>
+#include <securec.h>
+#include "camera_dump.h"
+
+extern "C" {
+#include <jpeglib.h>
+}
+
+namespace OHOS::Camera {
+static_assert(RkSocCaps::RGA_YUV420P_OUTPUT || (RkSocCaps::JPEG_SOURCE_FORMAT != CAMERA_FORMAT_YCRCB_420_P &&
+    RkSocCaps::VIDEO_SOURCE_FORMAT != CAMERA_FORMAT_YCRCB_420_P), "RGA of this SoC can not produce I420");
+static_assert(!RkSocCaps::JPEG_HW, "no hardware JPEG path is implemented, JPEG is encoded by libjpeg");
+
+static constexpr uint32_t VIDEO_MAX_IN_FLIGHT = 4; // 4:frames converted or encoded at the same time
+
+// streams running on the codec nodes of every camera, once none is left the pool frees what it caches
+static std::mutex g_codecStreamsLock;
+static uint32_t g_codecStreams = 0;
+
+RKCodecNode::RKCodecNode(const std::string& name, const std::string& type, const std::string &cameraId)
+    : NodeBase(name, type, cameraId)
+{
+    CAMERA_LOGV("%{public}s enter, type(%{public}s)\n", name_.c_str(), type_.c_str());
+    jpegSettings_.rotation = RkSocCaps::DEFAULT_JPEG_ROTATION;
+    jpegSettings_.quality = 100; // 100:jpeg quality
+}
+
+RKCodecNode::~RKCodecNode()
+{
+    StopVideoPipeline();
+    {
+        std::lock_guard<std::mutex> l(jpegBurstLock_);
+        jpegBurstPool_ = nullptr;
+    }
+    CAMERA_LOGI("~RKCodecNode Node exit.");
+}
+
+RetCode RKCodecNode::Start(const int32_t streamId)
+{
+    CAMERA_LOGI("RKCodecNode::Start streamId = %{public}d\n", streamId);
+    RkTransformPlanner::GetInstance().AddStage(streamId, RK_TRANSFORM_STAGE_CODEC);
+    {
+        std::lock_guard<std::mutex> l(g_codecStreamsLock);
+        if (streams_.insert(streamId).second) {
+            g_codecStreams++;
+        }
+    }
+    for (const auto& it : GetOutPorts()) {
+        if (static_cast<int32_t>(it->format_.streamId_) == streamId && it->format_.format_ == CAMERA_FORMAT_BLOB) {
+            std::lock_guard<std::mutex> l(zslLock_);
+            stillStreams_[streamId] = {static_cast<uint32_t>(it->format_.w_), static_cast<uint32_t>(it->format_.h_)};
+            SetZslCaptureSizeLocked();
+        }
+    }
+    return RC_OK;
+}
+
+RetCode RKCodecNode::Stop(const int32_t streamId)
+{
+    CAMERA_LOGI("RKCodecNode::Stop streamId = %{public}d\n", streamId);
+    if (streamId == encodeStreamId_) {
+        StopVideoPipeline();
+    }
+    DrainJpegBurst();
+    {
+        std::lock_guard<std::mutex> l(zslLock_);
+        stillStreams_.erase(streamId);
+        SetZslCaptureSizeLocked();
+        if (zslRing_ != nullptr) {
+            zslRing_->Clear();
+        }
+    }
+    RkNodeUtils::ReleaseRgaContext(streamId);
+    RkTransformPlanner::GetInstance().RemoveStage(streamId, RK_TRANSFORM_STAGE_CODEC);
+    ReleaseMemory(streamId);
+    RkBufferPool::GetInstance().LogStats("RKCodecNode");
+    RkDumpWriter::GetInstance().LogStats("RKCodecNode");
+    RK_TRACE_DUMP();
+    return RC_OK;
+}
+
+// once the node has no stream left its JPEG slabs go back to the pool, the last stream of all empties the pool
+void RKCodecNode::ReleaseMemory(int32_t streamId)
+{
+    bool nodeIdle = false;
+    bool allIdle = false;
+    {
+        std::lock_guard<std::mutex> l(g_codecStreamsLock);
+        if (streams_.erase(streamId) != 0) {
+            g_codecStreams--;
+        }
+        nodeIdle = streams_.empty();
+        allIdle = g_codecStreams == 0;
+    }
+    if (nodeIdle) {
+        std::lock_guard<std::mutex> l(jpegLock_);
+        jpegCompressor_.overflow.Release();
+        jpegStripPool_ = nullptr;
+    }
+    if (allIdle) {
+        RkBufferPool::GetInstance().Trim();
+    }
+}
+
+RetCode RKCodecNode::Flush(const int32_t streamId)
+{
+    CAMERA_LOGI("RKCodecNode::Flush streamId = %{public}d\n", streamId);
+    std::unique_lock<std::mutex> l(pipelineLock_);
+    if (streamId == encodeStreamId_ && videoPipeline_ != nullptr) {
+        videoPipeline_->Drain();
+    }
+    l.unlock();
+    DrainJpegBurst();
+    return RC_OK;
+}
+
+RetCode RKCodecNode::ConfigJpegOrientation(common_metadata_header_t* data, RkJpegSettings& settings)
+{
+    camera_metadata_item_t entry;
+    int ret = FindCameraMetadataItem(data, OHOS_JPEG_ORIENTATION, &entry);
+    if (ret != 0 || entry.data.i32 == nullptr) {
+        CAMERA_LOGI("tag OHOS_JPEG_ORIENTATION not found");
+        return RC_OK;
+    }
+
+    int32_t ohosRotation = *entry.data.i32;
+    if (ohosRotation == OHOS_CAMERA_JPEG_ROTATION_0) {
+        settings.rotation = 0;
+    } else if (ohosRotation == OHOS_CAMERA_JPEG_ROTATION_90) {
+        settings.rotation = 90; // 90:degrees clockwise
+    } else if (ohosRotation == OHOS_CAMERA_JPEG_ROTATION_180) {
+        settings.rotation = 180; // 180:degrees clockwise
+    } else {
+        settings.rotation = 270; // 270:degrees clockwise
+    }
+    return RC_OK;
+}
+
+RetCode RKCodecNode::ConfigJpegRotationMode(common_metadata_header_t* data, RkJpegSettings& settings)
+{
+    camera_metadata_item_t entry;
+    int ret = FindCameraMetadataItem(data, RK_JPEG_ROTATION_MODE, &entry);
+    if (ret != 0 || entry.data.u8 == nullptr) {
+        settings.rotationMode = RK_JPEG_ROTATE_PIXELS;
+        return RC_OK;
+    }
+    settings.rotationMode = *entry.data.u8 == RK_JPEG_ROTATE_EXIF ? RK_JPEG_ROTATE_EXIF : RK_JPEG_ROTATE_PIXELS;
+    CAMERA_LOGI("RK_JPEG_ROTATION_MODE is = %{public}u", settings.rotationMode);
+    return RC_OK;
+}
+
+RetCode RKCodecNode::ConfigVideoRateControl(common_metadata_header_t* data)
+{
+    // tags missing from the metadata keep their value, a change reaches the running encoder on its next frame
+    camera_metadata_item_t entry;
+    std::unique_lock<std::mutex> l(videoRcLock_);
+    RkRateControl rc = videoRc_;
+    if (FindCameraMetadataItem(data, RK_VIDEO_RATE_CONTROL, &entry) == 0 && entry.data.u8 != nullptr) {
+        uint8_t mode = *entry.data.u8;
+        rc.mode = mode == RK_VIDEO_RC_CBR ? MPP_ENC_RC_MODE_CBR :
+            (mode == RK_VIDEO_RC_CQP ? MPP_ENC_RC_MODE_FIXQP : MPP_ENC_RC_MODE_VBR);
+    }
+    if (FindCameraMetadataItem(data, RK_VIDEO_BITRATE, &entry) == 0 && entry.data.i32 != nullptr &&
+        *entry.data.i32 > 0) {
+        rc.bitrate = static_cast<uint32_t>(*entry.data.i32);
+    }
+    if (FindCameraMetadataItem(data, RK_VIDEO_GOP, &entry) == 0 && entry.data.i32 != nullptr &&
+        *entry.data.i32 > 0) {
+        rc.gop = static_cast<uint32_t>(*entry.data.i32);
+    }
+    if (FindCameraMetadataItem(data, RK_VIDEO_QP, &entry) == 0 && entry.data.i32 != nullptr) {
+        rc.qp = std::clamp(*entry.data.i32, 0, 51); // 51:highest QP of H.264 and H.265
+    }
+    // the upper end of the requested range is the rate the sensor runs at
+    if (FindCameraMetadataItem(data, OHOS_CONTROL_FPS_RANGES, &entry) == 0 && entry.data.i32 != nullptr &&
+        entry.count >= 2 && entry.data.i32[1] > 0) { // 2:min and max
+        rc.fps = static_cast<uint32_t>(entry.data.i32[1]);
+    }
+    if (rc != videoRc_) {
+        CAMERA_LOGI("RKCodecNode video rate control mode %{public}d bitrate %{public}u fps %{public}u "
+            "gop %{public}u qp %{public}d", rc.mode, rc.bitrate, rc.fps, rc.gop, rc.qp);
+        videoRc_ = rc;
+    }
+    l.unlock();
+
+    if (FindCameraMetadataItem(data, RK_VIDEO_REQUEST_IDR, &entry) == 0 && entry.data.u8 != nullptr &&
+        *entry.data.u8 != 0) {
+        std::lock_guard<std::mutex> lock(pipelineLock_);
+        if (encodeSession_ >= 0) {
+            RkEncoderService::GetInstance().RequestIdr(encodeSession_);
+        }
+    }
+    return RC_OK;
+}
+
+RetCode RKCodecNode::ConfigJpegBurst(common_metadata_header_t* data)
+{
+    camera_metadata_item_t entry;
+    int ret = FindCameraMetadataItem(data, RK_JPEG_BURST, &entry);
+    if (ret != 0 || entry.data.u8 == nullptr) {
+        return RC_OK;
+    }
+    std::lock_guard<std::mutex> l(jpegBurstLock_);
+    if (jpegBurst_ != (*entry.data.u8 != 0)) {
+        jpegBurst_ = *entry.data.u8 != 0;
+        CAMERA_LOGI("RK_JPEG_BURST is = %{public}d", jpegBurst_);
+    }
+    return RC_OK;
+}
+
+RetCode RKCodecNode::ConfigJpegZsl(common_metadata_header_t* data)
+{
+    camera_metadata_item_t entry;
+    int ret = FindCameraMetadataItem(data, RK_JPEG_ZSL, &entry);
+    if (ret != 0 || entry.data.u8 == nullptr) {
+        return RC_OK;
+    }
+    std::lock_guard<std::mutex> l(zslLock_);
+    uint32_t depth = *entry.data.u8;
+    if (depth != zslDepth_) {
+        // captures still holding a frame of the old ring keep it until they are encoded
+        zslDepth_ = depth;
+        zslRing_ = depth == 0 ? nullptr : std::make_shared<RkZslRing>(depth);
+        SetZslCaptureSizeLocked();
+        CAMERA_LOGI("RK_JPEG_ZSL is = %{public}u", depth);
+    }
+    return RC_OK;
+}
+
+RkJpegSettings RKCodecNode::GetJpegSettings()
+{
+    std::lock_guard<std::mutex> l(jpegSettingsLock_);
+    return jpegSettings_;
+}
+
+std::shared_ptr<RkZslRing> RKCodecNode::GetZslRing()
+{
+    std::lock_guard<std::mutex> l(zslLock_);
+    return zslRing_;
+}
+
+// the ring is only filled while a still stream is configured, with frames the largest of them can use
+void RKCodecNode::SetZslCaptureSizeLocked()
+{
+    if (zslRing_ == nullptr) {
+        return;
+    }
+    uint32_t width = 0;
+    uint32_t height = 0;
+    for (const auto& [streamId, size] : stillStreams_) {
+        if (static_cast<uint64_t>(size.first) * size.second > static_cast<uint64_t>(width) * height) {
+            width = size.first;
+            height = size.second;
+        }
+    }
+    zslRing_->SetCaptureSize(width, height);
+}
+
+RetCode RKCodecNode::ConfigJpegQuality(common_metadata_header_t* data, RkJpegSettings& settings)
+{
+    camera_metadata_item_t entry;
+    int ret = FindCameraMetadataItem(data, OHOS_JPEG_QUALITY, &entry);
+    if (ret != 0) {
+        CAMERA_LOGI("tag OHOS_JPEG_QUALITY not found");
+        return RC_OK;
+    }
+
+    const int HIGH_QUALITY_JPEG = 100;
+    const int MIDDLE_QUALITY_JPEG = 95;
+    const int LOW_QUALITY_JPEG = 85;
+
+    CAMERA_LOGI("OHOS_JPEG_QUALITY is = %{public}d", static_cast<int>(entry.data.u8[0]));
+    if (*entry.data.i32 == OHOS_CAMERA_JPEG_LEVEL_LOW) {
+        settings.quality = LOW_QUALITY_JPEG;
+    } else if (*entry.data.i32 == OHOS_CAMERA_JPEG_LEVEL_MIDDLE) {
+        settings.quality = MIDDLE_QUALITY_JPEG;
+    } else if (*entry.data.i32 == OHOS_CAMERA_JPEG_LEVEL_HIGH) {
+        settings.quality = HIGH_QUALITY_JPEG;
+    } else {
+        settings.quality = HIGH_QUALITY_JPEG;
+    }
+    return RC_OK;
+}
+
+RetCode RKCodecNode::Config(const int32_t streamId, const CaptureMeta& meta)
+{
+    if (meta == nullptr) {
+        CAMERA_LOGE("meta is nullptr");
+        return RC_ERROR;
+    }
+
+    common_metadata_header_t* data = meta->get();
+    if (data == nullptr) {
+        CAMERA_LOGE("data is nullptr");
+        return RC_ERROR;
+    }
+
+    // the JPEG settings of one request are applied together, a capture never sees half of them
+    RetCode rc = RC_OK;
+    {
+        std::lock_guard<std::mutex> l(jpegSettingsLock_);
+        RkJpegSettings settings = jpegSettings_;
+        rc = ConfigJpegOrientation(data, settings);
+        rc = ConfigJpegRotationMode(data, settings);
+        rc = ConfigJpegQuality(data, settings);
+        jpegSettings_ = settings;
+    }
+    rc = ConfigVideoRateControl(data);
+    rc = ConfigJpegBurst(data);
+    rc = ConfigJpegZsl(data);
+    return rc;
+}
+
+static constexpr int JPEG_MCU_LUMA_ROWS = 16;   // 16:luma rows of one 4:2:0 MCU row
+static constexpr int JPEG_MCU_CHROMA_ROWS = 8;  // 8:chroma rows of one 4:2:0 MCU row
+static constexpr int JPEG_MCU_WIDTH = 16;       // 16:luma columns of one 4:2:0 MCU
+static constexpr int JPEG_STRIP_MIN_MCU_ROWS = 8;               // 8:MCU rows, fewer cost more than they save
+static constexpr int64_t JPEG_STRIP_MIN_PIXELS = 1280 * 960;    // 1280 * 960:smaller captures are encoded in one piece
+
+// Planes of a 4:2:0 frame, from the luma row a strip starts at. v is unused for NV12, u is the CbCr plane.
+struct JpegPlanes {
+    const unsigned char* y;
+    const unsigned char* u;
+    const unsigned char* v;
+};
+
+static JpegPlanes GetJpegPlanes(const unsigned char* image, int width, int height, int firstRow)
+{
+    const int chromaWidth = (width + 1) / 2;
+    const int chromaHeight = (height + 1) / 2;
+    JpegPlanes planes = {};
+    planes.y = image + firstRow * width;
+    if constexpr (RkSocCaps::JPEG_SOURCE_FORMAT == CAMERA_FORMAT_YCRCB_420_SP) {
+        planes.u = image + width * height + firstRow / 2 * width;
+    } else {
+        planes.u = image + width * height + firstRow / 2 * chromaWidth;
+        planes.v = image + width * height + chromaWidth * chromaHeight + firstRow / 2 * chromaWidth;
+    }
+    return planes;
+}
+
+static JSAMPROW GetRawRow(const unsigned char* plane, int row, int width, int height,
+    int paddedWidth, JSAMPROW padRow)
+{
+    const unsigned char* src = plane + (row < height ? row : height - 1) * width;
+    if (padRow == nullptr) {
+        return const_cast<JSAMPROW>(src);
+    }
+    // libjpeg reads whole MCUs, replicate the last column into the padding
+    (void)memcpy_s(padRow, paddedWidth, src, width);
+    (void)memset_s(padRow + width, paddedWidth - width, src[width - 1], paddedWidth - width);
+    return padRow;
+}
+
+/*
+ * Feed an I420 image to libjpeg as raw downsampled data: the planes are handed over as they are,
+ * libjpeg does neither colour conversion nor downsampling.
+ */
+static void WriteRawYuv420p(jpeg_compress_struct& cInfo, const JpegPlanes& image, int width, int height)
+{
+    const int chromaWidth = (width + 1) / 2;
+    const int chromaHeight = (height + 1) / 2;
+    const int paddedWidth = (width + JPEG_MCU_WIDTH - 1) / JPEG_MCU_WIDTH * JPEG_MCU_WIDTH;
+    const int paddedChromaWidth = paddedWidth / 2;
+    const unsigned char* yPlane = image.y;
+    const unsigned char* uPlane = image.u;
+    const unsigned char* vPlane = image.v;
+
+    RkPoolBuffer padding;
+    JSAMPROW yPad[JPEG_MCU_LUMA_ROWS] = {};
+    JSAMPROW uPad[JPEG_MCU_CHROMA_ROWS] = {};
+    JSAMPROW vPad[JPEG_MCU_CHROMA_ROWS] = {};
+    if (paddedWidth != width) {
+        padding = RkBufferPool::GetInstance().Acquire(JPEG_MCU_LUMA_ROWS * paddedWidth +
+            JPEG_MCU_LUMA_ROWS * paddedChromaWidth);
+        JSAMPLE* p = padding.GetData();
+        for (int i = 0; i < JPEG_MCU_LUMA_ROWS; i++, p += paddedWidth) {
+            yPad[i] = p;
+        }
+        for (int i = 0; i < JPEG_MCU_CHROMA_ROWS; i++, p += paddedChromaWidth) {
+            uPad[i] = p;
+            vPad[i] = p + JPEG_MCU_CHROMA_ROWS * paddedChromaWidth;
+        }
+    }
+
+    JSAMPROW yRows[JPEG_MCU_LUMA_ROWS];
+    JSAMPROW uRows[JPEG_MCU_CHROMA_ROWS];
+    JSAMPROW vRows[JPEG_MCU_CHROMA_ROWS];
+    JSAMPARRAY planes[] = {yRows, uRows, vRows};
+    while (cInfo.next_scanline < cInfo.image_height) {
+        int row = static_cast<int>(cInfo.next_scanline);
+        for (int i = 0; i < JPEG_MCU_LUMA_ROWS; i++) {
+            yRows[i] = GetRawRow(yPlane, row + i, width, height, paddedWidth, yPad[i]);
+        }
+        for (int i = 0; i < JPEG_MCU_CHROMA_ROWS; i++) {
+            uRows[i] = GetRawRow(uPlane, row / 2 + i, chromaWidth, chromaHeight, paddedChromaWidth, uPad[i]);
+            vRows[i] = GetRawRow(vPlane, row / 2 + i, chromaWidth, chromaHeight, paddedChromaWidth, vPad[i]);
+        }
+        jpeg_write_raw_data(&cInfo, planes, JPEG_MCU_LUMA_ROWS);
+    }
+}
+
+/*
+ * Feed an NV12 image to libjpeg as raw downsampled data. Luma rows are handed over in place,
+ * the interleaved chroma rows are split into Cb/Cr rows, libjpeg neither converts nor downsamples.
+ */
+static void WriteRawNv12(jpeg_compress_struct& cInfo, const JpegPlanes& image, int width, int height)
+{
+    const int chromaWidth = (width + 1) / 2;
+    const int chromaHeight = (height + 1) / 2;
+    const int paddedWidth = (width + JPEG_MCU_WIDTH - 1) / JPEG_MCU_WIDTH * JPEG_MCU_WIDTH;
+    const int paddedChromaWidth = paddedWidth / 2;
+    const unsigned char* yPlane = image.y;
+    const unsigned char* uvPlane = image.u;
+    const bool padLuma = paddedWidth != width;
+
+    std::vector<JSAMPLE> rows((padLuma ? JPEG_MCU_LUMA_ROWS * paddedWidth : 0) +
+        2 * JPEG_MCU_CHROMA_ROWS * paddedChromaWidth); // 2:Cb and Cr
+    JSAMPROW yRows[JPEG_MCU_LUMA_ROWS];
+    JSAMPROW uRows[JPEG_MCU_CHROMA_ROWS];
+    JSAMPROW vRows[JPEG_MCU_CHROMA_ROWS];
+    JSAMPLE* p = rows.data();
+    for (int i = 0; i < JPEG_MCU_CHROMA_ROWS; i++, p += paddedChromaWidth) {
+        uRows[i] = p;
+        vRows[i] = p + JPEG_MCU_CHROMA_ROWS * paddedChromaWidth;
+    }
+    p += JPEG_MCU_CHROMA_ROWS * paddedChromaWidth;
+    JSAMPARRAY planes[] = {yRows, uRows, vRows};
+
+    while (cInfo.next_scanline < cInfo.image_height) {
+        int row = static_cast<int>(cInfo.next_scanline);
+        for (int i = 0; i < JPEG_MCU_LUMA_ROWS; i++) {
+            const unsigned char* src = yPlane + std::min(row + i, height - 1) * width;
+            if (!padLuma) {
+                yRows[i] = const_cast<JSAMPROW>(src);
+                continue;
+            }
+            yRows[i] = p + i * paddedWidth;
+            (void)memcpy_s(yRows[i], paddedWidth, src, width);
+            (void)memset_s(yRows[i] + width, paddedWidth - width, src[width - 1], paddedWidth - width);
+        }
+        for (int i = 0; i < JPEG_MCU_CHROMA_ROWS; i++) {
+            const unsigned char* src = uvPlane + std::min(row / 2 + i, chromaHeight - 1) * width;
+            for (int x = 0; x < paddedChromaWidth; x++) {
+                int sx = std::min(x, chromaWidth - 1) * 2; // 2:interleaved Cb Cr
+                uRows[i][x] = src[sx];
+                vRows[i][x] = src[sx + 1];
+            }
+        }
+        jpeg_write_raw_data(&cInfo, planes, JPEG_MCU_LUMA_ROWS);
+    }
+}
+
+/*
+ * A minimal EXIF APP1 segment holding only IFD0 with the Orientation tag, so that viewers rotate
+ * a frame which was encoded as captured. It is zero padded to the largest EXIF template, which the
+ * EXIF node then writes over it without moving the scan.
+ */
+static void WriteExifOrientation(jpeg_compress_struct& cInfo, uint32_t rotation)
+{
+    uint8_t orientation = 1; // 1:top-left, no rotation
+    if (rotation == 90) { // 90:degrees clockwise
+        orientation = 6; // 6:right-top
+    } else if (rotation == 180) { // 180:degrees clockwise
+        orientation = 3; // 3:bottom-right
+    } else if (rotation == 270) { // 270:degrees clockwise
+        orientation = 8; // 8:left-bottom
+    }
+    const JOCTET exif[] = {
+        'E', 'x', 'i', 'f', 0x00, 0x00,
+        'M', 'M', 0x00, 0x2A, 0x00, 0x00, 0x00, 0x08,             // big endian TIFF header, IFD0 at 8
+        0x00, 0x01,                                               // one entry
+        0x01, 0x12, 0x00, 0x03, 0x00, 0x00, 0x00, 0x01,           // Orientation, SHORT, count 1
+        0x00, orientation, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00,                                   // no IFD1
+    };
+    std::vector<JOCTET> segment(std::max(sizeof(exif), RkExifTemplate::GetMaxSize() - 4), 0); // 4:marker, length
+    (void)memcpy_s(segment.data(), segment.size(), exif, sizeof(exif));
+    jpeg_write_marker(&cInfo, JPEG_APP0 + 1, segment.data(), segment.size());
+}
+
+static constexpr size_t JPEG_OVERFLOW_MIN_SIZE = 64 * 1024; // 64 * 1024:first overflow allocation
+static constexpr size_t JPEG_DISCARD_SIZE = 4096;           // 4096:sink for output nothing can hold
+
+/*
+ * libjpeg destination writing straight into a caller provided buffer. Output that does not fit
+ * continues in the overflow buffer, a pooled slab that keeps its capacity from one capture to the next.
+ */
+struct JpegBufferDest {
+    struct jpeg_destination_mgr pub;
+    JOCTET* output;
+    size_t outputSize;
+    RkPoolBuffer* overflow;
+    bool overflowed;
+    bool discarding;
+};
+
+// points libjpeg at the overflow buffer from used on, or at the discard sink when it could not be allocated
+static void ContinueInOverflow(JpegBufferDest* dest, size_t used)
+{
+    RkPoolBuffer& overflow = *dest->overflow;
+    dest->overflowed = true;
+    if (overflow.GetData() == nullptr) {
+        // out of memory: the rest of the stream is thrown away and the image reported as too large
+        static thread_local JOCTET discard[JPEG_DISCARD_SIZE];
+        dest->discarding = true;
+        dest->pub.next_output_byte = discard;
+        dest->pub.free_in_buffer = sizeof(discard);
+        return;
+    }
+    dest->pub.next_output_byte = overflow.GetData() + used;
+    dest->pub.free_in_buffer = overflow.GetSize() - used;
+}
+
+static void InitBufferDest(j_compress_ptr cInfo)
+{
+    JpegBufferDest* dest = reinterpret_cast<JpegBufferDest*>(cInfo->dest);
+    dest->overflowed = false;
+    dest->discarding = false;
+    if (dest->output == nullptr) {
+        // libjpeg stores a byte before it checks the room left, so it must start in a real buffer
+        RkBufferPool::GetInstance().Reserve(*dest->overflow, JPEG_OVERFLOW_MIN_SIZE);
+        ContinueInOverflow(dest, 0);
+        return;
+    }
+    dest->pub.next_output_byte = dest->output;
+    dest->pub.free_in_buffer = dest->outputSize;
+}
+
+static boolean EmptyBufferDest(j_compress_ptr cInfo)
+{
+    // only called once the current buffer is full
+    JpegBufferDest* dest = reinterpret_cast<JpegBufferDest*>(cInfo->dest);
+    RkPoolBuffer& overflow = *dest->overflow;
+    size_t used = 0;
+    if (dest->discarding) {
+        dest->pub.next_output_byte -= JPEG_DISCARD_SIZE;
+        dest->pub.free_in_buffer = JPEG_DISCARD_SIZE;
+        return TRUE;
+    } else if (!dest->overflowed) {
+        RkBufferPool::GetInstance().Reserve(overflow, JPEG_OVERFLOW_MIN_SIZE);
+    } else {
+        used = overflow.GetSize();
+        RkPoolBuffer larger = RkBufferPool::GetInstance().Acquire(used * 2); // 2:grow geometrically
+        if (larger.GetData() != nullptr) {
+            (void)memcpy_s(larger.GetData(), larger.GetSize(), overflow.GetData(), used);
+        }
+        overflow = std::move(larger);
+    }
+    ContinueInOverflow(dest, used);
+    return TRUE;
+}
+
+static void TermBufferDest(j_compress_ptr cInfo)
+{
+    (void)cInfo;
+}
+
+static size_t GetBufferDestSize(const JpegBufferDest& dest)
+{
+    if (dest.discarding) {
+        return SIZE_MAX;
+    }
+    if (!dest.overflowed) {
+        return dest.outputSize - dest.pub.free_in_buffer;
+    }
+    return dest.outputSize + dest.overflow->GetSize() - dest.pub.free_in_buffer;
+}
+
+struct JpegEncodeJob {
+    JpegPlanes planes = {};
+    int width = 0;
+    int height = 0;                 // rows of the frame, or of the strip
+    uint32_t quality = 0;
+    uint32_t exifRotation = 0;
+    bool headers = true;            // JFIF or EXIF, the strips after the first one only contribute their scan
+    bool restartEveryRow = false;
+    unsigned char* output = nullptr;
+    size_t outputSize = 0;
+    RkPoolBuffer* overflow = nullptr;
+};
+
+static size_t EncodeJpegToMemory(RkJpegCompressor& compressor, const JpegEncodeJob& job)
+{
+    // the compressor is reused, jpeg_set_defaults below resets whatever the previous image set
+    jpeg_compress_struct& cInfo = compressor.info;
+    constexpr uint32_t colorMap = 3;
+    constexpr uint32_t samplingFactor = 2;
+
+    cInfo.image_width = job.width;
+    cInfo.image_height = job.height;
+    cInfo.input_components = colorMap;
+    cInfo.in_color_space = JCS_YCbCr;
+
+    jpeg_set_defaults(&cInfo);
+    CAMERA_LOGD("RKCodecNode::EncodeJpegToMemory quality is = %{public}u", job.quality);
+    jpeg_set_quality(&cInfo, job.quality, TRUE);
+    cInfo.raw_data_in = TRUE;
+    cInfo.comp_info[0].h_samp_factor = samplingFactor;
+    cInfo.comp_info[0].v_samp_factor = samplingFactor;
+    cInfo.comp_info[1].h_samp_factor = 1;
+    cInfo.comp_info[1].v_samp_factor = 1;
+    cInfo.comp_info[2].h_samp_factor = 1; // 2:Cr component
+    cInfo.comp_info[2].v_samp_factor = 1; // 2:Cr component
+    // strips are stitched on restart markers, they need the standard Huffman tables every strip shares
+    cInfo.optimize_coding = FALSE;
+    cInfo.restart_in_rows = job.restartEveryRow ? 1 : 0;
+    // EXIF requires APP1 to be the first marker, so it replaces the JFIF APP0
+    cInfo.write_JFIF_header = FALSE;
+    JpegBufferDest dest = {};
+    dest.pub.init_destination = InitBufferDest;
+    dest.pub.empty_output_buffer = EmptyBufferDest;
+    dest.pub.term_destination = TermBufferDest;
+    dest.output = job.output;
+    dest.outputSize = job.output == nullptr ? 0 : job.outputSize;
+    dest.overflow = job.overflow != nullptr ? job.overflow : &compressor.overflow;
+    cInfo.dest = &dest.pub;
+    jpeg_start_compress(&cInfo, TRUE);
+
+    if (job.headers) {
+        WriteExifOrientation(cInfo, job.exifRotation);
+    }
+
+    if constexpr (RkSocCaps::JPEG_SOURCE_FORMAT == CAMERA_FORMAT_YCRCB_420_SP) {
+        WriteRawNv12(cInfo, job.planes, job.width, job.height);
+    } else {
+        WriteRawYuv420p(cInfo, job.planes, job.width, job.height);
+    }
+
+    jpeg_finish_compress(&cInfo);
+    return GetBufferDestSize(dest);
+}
+
+void RKCodecNode::EncodeJpeg(const std::shared_ptr<IBuffer>& buffer, RkJpegCompressor& compressor,
+    uint32_t quality, uint32_t exifRotation)
+{
+    // the JPEG is written straight into the surface buffer, which is free while the frame is in virAddr
+    size_t surfaceSize = buffer->GetSuffaceBufferSize();
+    JpegEncodeJob job;
+    job.width = static_cast<int>(buffer->GetCurWidth());
+    job.height = static_cast<int>(buffer->GetCurHeight());
+    job.planes = GetJpegPlanes(static_cast<const unsigned char*>(buffer->GetVirAddress()), job.width, job.height, 0);
+    job.quality = quality;
+    job.exifRotation = exifRotation;
+    job.output = static_cast<unsigned char*>(buffer->GetSuffaceBufferAddr());
+    job.outputSize = surfaceSize;
+    size_t jpegSize = EncodeJpegToMemory(compressor, job);
+    SetJpegResult(buffer, jpegSize);
+}
+
+void RKCodecNode::SetJpegResult(const std::shared_ptr<IBuffer>& buffer, size_t jpegSize)
+{
+    size_t surfaceSize = buffer->GetSuffaceBufferSize();
+    if (jpegSize != 0 && jpegSize <= surfaceSize) {
+        buffer->SetIsValidDataInSurfaceBuffer(true);
+        buffer->SetEsFrameSize(jpegSize);
+    } else {
+        CAMERA_LOGE("RKCodecNode::EncodeJpeg jpegSize %{public}zu does not fit surface buffer %{public}zu",
+            jpegSize, surfaceSize);
+        buffer->SetEsFrameSize(0);
+    }
+    CAMERA_LOGD("RKCodecNode::EncodeJpeg jpegSize = %{public}zu\n", jpegSize);
+}
+
+bool RKCodecNode::EncodeJpegStrips(const std::shared_ptr<IBuffer>& buffer, uint32_t quality, uint32_t exifRotation)
+{
+    const int width = static_cast<int>(buffer->GetCurWidth());
+    const int height = static_cast<int>(buffer->GetCurHeight());
+    const int mcuRows = (height + JPEG_MCU_LUMA_ROWS - 1) / JPEG_MCU_LUMA_ROWS;
+    int strips = std::min(static_cast<int>(RkSocCaps::JPEG_BURST_WORKERS), mcuRows / JPEG_STRIP_MIN_MCU_ROWS);
+    // a single strip is the plain encode with restart markers added
+    if (static_cast<int64_t>(width) * height < JPEG_STRIP_MIN_PIXELS || strips <= 1 || height > UINT16_MAX) {
+        return false;
+    }
+    const int stripMcuRows = (mcuRows + strips - 1) / strips;
+    strips = (mcuRows + stripMcuRows - 1) / stripMcuRows;
+    if (jpegStripPool_ == nullptr) {
+        jpegStripPool_ = std::make_unique<RkJpegBurstPool>(cameraIds_ + " jpeg strips", RkSocCaps::JPEG_BURST_WORKERS);
+    }
+
+    std::vector<RkPoolBuffer> outputs(strips);
+    std::vector<size_t> sizes(strips, 0);
+    std::mutex lock;
+    std::condition_variable cv;
+    int remaining = strips;
+    const unsigned char* image = static_cast<const unsigned char*>(buffer->GetVirAddress());
+    for (int i = 0; i < strips; i++) {
+        JpegEncodeJob job;
+        int firstRow = i * stripMcuRows * JPEG_MCU_LUMA_ROWS;
+        job.width = width;
+        job.height = std::min(stripMcuRows * JPEG_MCU_LUMA_ROWS, height - firstRow);
+        job.planes = GetJpegPlanes(image, width, height, firstRow);
+        job.quality = quality;
+        job.exifRotation = exifRotation;
+        job.headers = i == 0;
+        job.restartEveryRow = true;
+        job.overflow = &outputs[i];
+        // a byte per pixel is a guess, not a bound: it holds the strip at the usual qualities, detailed
+        // content at high quality can exceed it and then the destination grows the buffer by copying
+        RkBufferPool::GetInstance().Reserve(outputs[i], static_cast<size_t>(width) * job.height);
+        size_t* size = &sizes[i];
+        jpegStripPool_->Submit(
+            [job, size, buffer](RkJpegCompressor& compressor) {
+                RK_TRACE_SCOPE("RKCodecNode jpeg strip", buffer);
+                *size = EncodeJpegToMemory(compressor, job);
+            },
+            [&lock, &cv, &remaining]() {
+                std::lock_guard<std::mutex> l(lock);
+                remaining--;
+                cv.notify_all();
+            });
+    }
+    {
+        std::unique_lock<std::mutex> l(lock);
+        cv.wait(l, [&remaining] { return remaining == 0; });
+    }
+
+    std::vector<RkJpegStrip> parts;
+    for (int i = 0; i < strips; i++) {
+        if (sizes[i] == 0 || sizes[i] > outputs[i].GetSize()) {
+            CAMERA_LOGE("RKCodecNode::EncodeJpegStrips strip %{public}d failed", i);
+            SetJpegResult(buffer, 0);
+            return true;
+        }
+        parts.push_back({outputs[i].GetData(), sizes[i], static_cast<uint32_t>(i * stripMcuRows)});
+    }
+    size_t jpegSize = RkJpegStripStitcher::Stitch(parts, static_cast<uint16_t>(height),
+        static_cast<uint8_t*>(buffer->GetSuffaceBufferAddr()), buffer->GetSuffaceBufferSize());
+    RkTransformPlanner::GetInstance().AddCpuCopy(buffer->GetStreamId(), jpegSize);
+    SetJpegResult(buffer, jpegSize);
+    return true;
+}
+
+void RKCodecNode::PrepareJpegFrame(std::shared_ptr<IBuffer>& buffer, uint32_t pixelRotation)
+{
+    // with ZSL the frame received at the shutter replaces the one that came with the capture, in the same
+    // RGA pass that scales, converts and rotates it for libjpeg; a frame smaller than the JPEG is not used
+    std::shared_ptr<RkZslRing> ring = GetZslRing();
+    std::shared_ptr<const RkZslFrame> frame = ring == nullptr ? nullptr :
+        ring->Pick(buffer->GetCaptureId(), buffer->GetWidth(), buffer->GetHeight());
+    if (frame != nullptr && RkNodeUtils::BufferLoadFrame(buffer, frame->image, RkSocCaps::JPEG_SOURCE_FORMAT,
+        pixelRotation) == RC_OK) {
+        CAMERA_LOGD("RKCodecNode::PrepareJpegFrame captureId[%{public}d] from ZSL frame %{public}u x %{public}u",
+            buffer->GetCaptureId(), frame->image.width, frame->image.height);
+        return;
+    }
+    RkNodeUtils::BufferScaleFormatTransform(buffer, RkSocCaps::JPEG_SOURCE_FORMAT, false, pixelRotation);
+}
+
+void RKCodecNode::Yuv420ToJpeg(std::shared_ptr<IBuffer>& buffer)
+{
+    CAMERA_LOGD("RKCodecNode::Yuv422ToJpeg begin");
+
+    // libjpeg takes the planes as they are, no RGB round trip. The rotation is either done by RGA in the
+    // same pass or left to the viewer through EXIF, the JPEG is never decoded and rotated again.
+    RkJpegSettings settings = GetJpegSettings();
+    uint32_t pixelRotation = settings.rotationMode == RK_JPEG_ROTATE_PIXELS ? settings.rotation : 0;
+    uint32_t exifRotation = settings.rotationMode == RK_JPEG_ROTATE_EXIF ? settings.rotation : 0;
+    PrepareJpegFrame(buffer, pixelRotation);
+    if (buffer->GetBufferStatus() != CAMERA_BUFFER_STATUS_OK) {
+        return;
+    }
+
+    // a large capture is split into strips encoded on all cores, the shutter waits for the slowest strip only
+    std::unique_lock<std::mutex> l(jpegLock_);
+    if (!EncodeJpegStrips(buffer, settings.quality, exifRotation)) {
+        EncodeJpeg(buffer, jpegCompressor_, settings.quality, exifRotation);
+    }
+}
+
+void RKCodecNode::SubmitJpegBurst(std::shared_ptr<IBuffer>& buffer)
+{
+    // RGA stays on the delivering thread, only libjpeg is spread over the cores
+    RkJpegSettings settings = GetJpegSettings();
+    uint32_t pixelRotation = settings.rotationMode == RK_JPEG_ROTATE_PIXELS ? settings.rotation : 0;
+    uint32_t exifRotation = settings.rotationMode == RK_JPEG_ROTATE_EXIF ? settings.rotation : 0;
+    uint32_t quality = settings.quality;
+    PrepareJpegFrame(buffer, pixelRotation);
+
+    std::lock_guard<std::mutex> l(jpegBurstLock_);
+    if (jpegBurstPool_ == nullptr) {
+        jpegBurstPool_ = std::make_unique<RkJpegBurstPool>(cameraIds_ + " jpeg", RkSocCaps::JPEG_BURST_WORKERS);
+    }
+    std::shared_ptr<IBuffer> shot = buffer;
+    jpegBurstPool_->Submit(
+        [this, shot, quality, exifRotation](RkJpegCompressor& compressor) {
+            RK_TRACE_SCOPE("RKCodecNode jpeg burst", shot);
+            // a shot RGA failed on still goes through the pool, so it is delivered in its turn
+            if (shot->GetBufferStatus() == CAMERA_BUFFER_STATUS_OK) {
+                EncodeJpeg(shot, compressor, quality, exifRotation);
+            }
+        },
+        // delivered in the order the captures came in, whichever shot finished first
+        [this, shot]() mutable {
+            RkDumpWriter::GetInstance().Dump("board_RKCodecNode", ENABLE_RKCODEC_NODE_CONVERTED, shot);
+            NodeBase::DeliverBuffer(shot);
+        });
+}
+
+void RKCodecNode::DrainJpegBurst()
+{
+    std::lock_guard<std::mutex> l(jpegBurstLock_);
+    if (jpegBurstPool_ != nullptr) {
+        jpegBurstPool_->Drain();
+    }
+}
+
+void RKCodecNode::VideoConvert(RkCodecJob& job)
+{
+    std::shared_ptr<IBuffer>& buffer = job.buffer;
+    CAMERA_LOGD("RKCodecNode::VideoConvert begin");
+    // MPP reads the frame from the dma-buf, so convert (or just blit) straight into the surface buffer
+    RkNodeUtils::BufferScaleFormatTransform(buffer, RkSocCaps::VIDEO_SOURCE_FORMAT, true);
+    if (buffer->GetBufferStatus() != CAMERA_BUFFER_STATUS_OK) {
+        return;
+    }
+
+    if (!buffer->GetIsValidDataInSurfaceBuffer()) {
+        // only when RGA could not take the frame, e.g. a format it does not know
+        CAMERA_LOGW("RKCodecNode::VideoConvert streamId[%{public}d] copies the frame on the CPU",
+            buffer->GetStreamId());
+        RkTransformPlanner::GetInstance().AddCpuCopy(buffer->GetStreamId(), buffer->GetSuffaceBufferSize());
+        auto ret = memcpy_s(buffer->GetSuffaceBufferAddr(), buffer->GetSuffaceBufferSize(),
+            buffer->GetVirAddress(), buffer->GetSuffaceBufferSize());
+        if (ret != 0) {
+            CAMERA_LOGE("RKCodecNode::VideoConvert memcpy_s failed 1, ret = %{public}d\n", ret);
+            buffer->SetBufferStatus(CAMERA_BUFFER_STATUS_INVALID);
+        }
+    }
+}
+
+void RKCodecNode::VideoEncode(RkCodecJob& job)
+{
+    // runs on a pipeline thread, so the pipeline outlives the request
+    RkCodecPipeline* pipeline = videoPipeline_.get();
+    std::shared_ptr<IBuffer> buffer = job.buffer;
+    if (buffer->GetBufferStatus() != CAMERA_BUFFER_STATUS_OK) {
+        return pipeline->Forward(RkCodecPipeline::STAGE_ENCODE, std::move(job));
+    }
+
+    RkEncodeRequest request;
+    request.config.width = buffer->GetWidth();
+    request.config.height = buffer->GetHeight();
+    request.config.format = RkSocCaps::VIDEO_MPP_FORMAT;
+    request.config.type = videoEncodeType_ == ENCODE_TYPE_H265 ? MPP_VIDEO_CodingHEVC : MPP_VIDEO_CodingAVC;
+    {
+        std::lock_guard<std::mutex> l(videoRcLock_);
+        request.config.rc = videoRc_;
+    }
+    request.fd = buffer->GetFileDescriptor();
+    request.output = static_cast<unsigned char*>(buffer->GetVirAddress());
+    request.done = [pipeline, job](RetCode rc, size_t esSize, bool dropped) mutable {
+        job.esSize = esSize;
+        if (dropped) {
+            job.buffer->SetBufferStatus(CAMERA_BUFFER_STATUS_DROP);
+        } else if (rc != RC_OK) {
+            CAMERA_LOGE("RKCodecNode::VideoEncode failed, index = %{public}d", job.buffer->GetIndex());
+            job.buffer->SetBufferStatus(CAMERA_BUFFER_STATUS_INVALID);
+        }
+        pipeline->Forward(RkCodecPipeline::STAGE_ENCODE, std::move(job));
+    };
+    RkEncoderService::GetInstance().Submit(encodeSession_, std::move(request));
+}
+
+void RKCodecNode::VideoOutput(RkCodecJob& job)
+{
+    std::shared_ptr<IBuffer>& buffer = job.buffer;
+    if (buffer->GetBufferStatus() == CAMERA_BUFFER_STATUS_OK) {
+        RkNalCodec codec = videoEncodeType_ == ENCODE_TYPE_H265 ? RK_NAL_H265 : RK_NAL_H264;
+        RkNalScanner::Scan(static_cast<const uint8_t*>(buffer->GetVirAddress()), job.esSize, nalUnits_, codec);
+        buffer->SetEsKeyFrame(RkNalScanner::HasKeyFrame(nalUnits_, codec) ? 1 : 0);
+        buffer->SetEsFrameSize(job.esSize);
+        // stamp the frame with the time it entered the node, not the time its encode finished
+        buffer->SetEsTimestamp(job.timestamp);
+        buffer->SetIsValidDataInSurfaceBuffer(false);
+        CAMERA_LOGD("RKCodecNode::VideoOutput, es size = %{public}zu timestamp = %{public}lld\n",
+            job.esSize, static_cast<long long>(job.timestamp));
+    }
+
+    RkDumpWriter::GetInstance().Dump("board_RKCodecNode", ENABLE_RKCODEC_NODE_CONVERTED, buffer);
+    NodeBase::DeliverBuffer(buffer);
+}
+
+void RKCodecNode::SubmitVideo(std::shared_ptr<IBuffer>& buffer)
+{
+    std::unique_lock<std::mutex> l(pipelineLock_);
+    if (videoPipeline_ == nullptr) {
+        videoEncodeType_ = buffer->GetEncodeType();
+        videoPipeline_ = std::make_unique<RkCodecPipeline>(videoEncodeType_ == ENCODE_TYPE_H265 ? "h265" : "h264",
+            VIDEO_MAX_IN_FLIGHT);
+        videoPipeline_->SetStage(RkCodecPipeline::STAGE_CONVERT, [this](RkCodecJob& job) { VideoConvert(job); });
+        // completed by RkEncoderService, which shares the encoder with the other cameras and streams
+        videoPipeline_->SetStage(RkCodecPipeline::STAGE_ENCODE, [this](RkCodecJob& job) { VideoEncode(job); },
+            true);
+        videoPipeline_->SetStage(RkCodecPipeline::STAGE_OUTPUT, [this](RkCodecJob& job) { VideoOutput(job); });
+        encodeStreamId_ = buffer->GetStreamId();
+        encodeSession_ = RkEncoderService::GetInstance().OpenSession(cameraIds_ + " stream " +
+            std::to_string(encodeStreamId_));
+        videoPipeline_->Start();
+    }
+    videoPipeline_->Submit(buffer);
+}
+
+void RKCodecNode::StopVideoPipeline()
+{
+    std::unique_lock<std::mutex> l(pipelineLock_);
+    if (videoPipeline_ != nullptr) {
+        videoPipeline_->Stop();
+        videoPipeline_ = nullptr;
+        RkEncoderService::GetInstance().CloseSession(encodeSession_);
+        encodeSession_ = -1;
+    }
+}
+
+void RKCodecNode::DeliverBuffer(std::shared_ptr<IBuffer>& buffer)
+{
+    if (buffer == nullptr) {
+        CAMERA_LOGE("RKCodecNode::DeliverBuffer frameSpec is null");
+        return;
+    }
+
+    RK_TRACE_SCOPE("RKCodecNode", buffer);
+    if (buffer->GetBufferStatus() != CAMERA_BUFFER_STATUS_OK) {
+        CAMERA_LOGE("RKCodecNode::DeliverBuffer BufferStatus() != CAMERA_BUFFER_STATUS_OK");
+        return NodeBase::DeliverBuffer(buffer);
+    }
+
+    RkSourcePath path;
+    if (RkFormatNegotiator::GetInstance().GetPath(buffer->GetStreamId(), path)) {
+        // the source node does not describe the frame, it is what it negotiated for the stream
+        buffer->SetCurFormat(path.format);
+        buffer->SetCurWidth(path.width);
+        buffer->SetCurHeight(path.height);
+    } else if constexpr (RkSocCaps::SENSOR_FORMAT != 0) {
+        // the source node of this board does not describe the frame, it is the sensor format at buffer size
+        buffer->SetCurFormat(RkSocCaps::SENSOR_FORMAT);
+        buffer->SetCurWidth(buffer->GetWidth());
+        buffer->SetCurHeight(buffer->GetHeight());
+    }
+
+    int32_t id = buffer->GetStreamId();
+    CAMERA_LOGD("RKCodecNode::DeliverBuffer, streamId[%{public}d], index[%{public}d],\
+format = %{public}d, encode =  %{public}d",
+        id, buffer->GetIndex(), buffer->GetFormat(), buffer->GetEncodeType());
+
+    // the codec is the last stage of its streams, every scale and convert step before it is folded into
+    // the single transform below, to the format the frame leaves with or the one the encoder reads
+    bool transform = RkTransformPlanner::GetInstance().RunsTransform(id, RK_TRANSFORM_STAGE_CODEC);
+    int32_t encodeType = buffer->GetEncodeType();
+    std::shared_ptr<RkZslRing> ring = encodeType == ENCODE_TYPE_JPEG ? nullptr : GetZslRing();
+    // kept as the source delivered it, the copy runs on RGA while this stream converts its frame
+    RkZslCopy zslCopy = ring == nullptr ? RkZslCopy() : ring->Push(buffer);
+    bool jpegBurst = false;
+    if (encodeType == ENCODE_TYPE_JPEG) {
+        std::lock_guard<std::mutex> l(jpegBurstLock_);
+        jpegBurst = jpegBurst_;
+    }
+    if (encodeType == ENCODE_TYPE_JPEG && jpegBurst) {
+        // delivered downstream by RkJpegBurstPool once its turn comes
+        return SubmitJpegBurst(buffer);
+    } else if (encodeType == ENCODE_TYPE_JPEG) {
+        Yuv420ToJpeg(buffer);
+    } else if (encodeType == ENCODE_TYPE_H264 || encodeType == ENCODE_TYPE_H265) {
+        // delivered downstream by the output stage of the pipeline
+        zslCopy.Wait();
+        return SubmitVideo(buffer);
+    } else if (encodeType == ENCODE_TYPE_NULL) {
+        if (transform && buffer->GetIsValidDataInSurfaceBuffer()) {
+            // the transform first moves the frame out of the surface dma-buf the copy reads
+            zslCopy.Wait();
+        }
+        if (transform) {
+            RkNodeUtils::BufferScaleFormatTransform(buffer);
+        }
+        if (!buffer->GetIsValidDataInSurfaceBuffer()) {
+            // the stream copies the frame from virAddr into its surface buffer
+            RkTransformPlanner::GetInstance().AddCpuCopy(id, buffer->GetSuffaceBufferSize());
+        }
+    } else {
+        CAMERA_LOGI("RKCodecNode::DeliverBuffer StreamId %{public}d error, unknow encodeType, %{public}d",
+            id, encodeType);
+    }
+
+    RkDumpWriter::GetInstance().Dump("board_RKCodecNode", ENABLE_RKCODEC_NODE_CONVERTED, buffer);
+
+    zslCopy.Wait();
+    return NodeBase::DeliverBuffer(buffer);
+}
+
+RetCode RKCodecNode::Capture(const int32_t streamId, const int32_t captureId)
+{
+    CAMERA_LOGV("RKCodecNode::Capture");
+    std::shared_ptr<RkZslRing> ring = GetZslRing();
+    if (ring != nullptr) {
+        ring->Shutter(captureId);
+    }
+    std::unique_lock<std::mutex> l(pipelineLock_);
+    if (streamId == encodeStreamId_ && encodeSession_ >= 0) {
+        // a recording started on a running session begins with a key frame
+        RkEncoderService::GetInstance().RequestIdr(encodeSession_);
+    }
+    return RC_OK;
+}
+
+RetCode RKCodecNode::CancelCapture(const int32_t streamId)
+{
+    CAMERA_LOGI("RKCodecNode::CancelCapture streamid = %{public}d", streamId);
+    return RC_OK;
+}
+
+REGISTERNODE(RKCodecNode, {"RKCodec"})
+} // namespace OHOS::Camera
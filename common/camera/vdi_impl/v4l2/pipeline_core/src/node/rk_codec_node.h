@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HOS_CAMERA_RKCODEC_NODE_H
+#define HOS_CAMERA_RKCODEC_NODE_H
+
+#include <vector>
+#include <condition_variable>
+#include <ctime>
+#include <map>
+#include <mutex>
+#include <set>
+#include "device_manager_adapter.h"
+#include "utils.h"
+#include "camera.h"
+#include "source_node.h"
+#include "RockchipRga.h"
+#include "RgaUtils.h"
+#include "RgaApi.h"
+#include "rk_mpi.h"
+#include "mpp_env.h"
+#include "mpp_mem.h"
+#include "mpp_log.h"
+#include "mpp_common.h"
+#include "rk_buffer_pool.h"
+#include "rk_codec_pipeline.h"
+#include "rk_encoder_service.h"
+#include "rk_jpeg_burst.h"
+#include "rk_nal_scanner.h"
+#include "rk_zsl_ring.h"
+extern "C" {
+#include "mpi_enc_utils.h"
+}
+
+
+namespace OHOS::Camera {
+// what a capture is encoded with, set by one request and read as a whole
+struct RkJpegSettings {
+    uint32_t rotation = 0;      // clockwise degrees
+    uint8_t rotationMode = 0;
+    uint32_t quality = 0;
+};
+
+// Built by every RK board, SoC differences come from the rk_soc_caps.h of the board being built.
+class RKCodecNode : public NodeBase {
+public:
+    RKCodecNode(const std::string& name, const std::string& type, const std::string &cameraId);
+    ~RKCodecNode() override;
+    RetCode Start(const int32_t streamId) override;
+    RetCode Stop(const int32_t streamId) override;
+    void DeliverBuffer(std::shared_ptr<IBuffer>& buffer) override;
+    virtual RetCode Capture(const int32_t streamId, const int32_t captureId) override;
+    RetCode CancelCapture(const int32_t streamId) override;
+    RetCode Flush(const int32_t streamId);
+    RetCode ConfigJpegOrientation(common_metadata_header_t* data, RkJpegSettings& settings);
+    RetCode ConfigJpegQuality(common_metadata_header_t* data, RkJpegSettings& settings);
+    RetCode ConfigJpegRotationMode(common_metadata_header_t* data, RkJpegSettings& settings);
+    RetCode ConfigJpegBurst(common_metadata_header_t* data);
+    RetCode ConfigJpegZsl(common_metadata_header_t* data);
+    RetCode ConfigVideoRateControl(common_metadata_header_t* data);
+    RetCode Config(const int32_t streamId, const CaptureMeta& meta) override;
+private:
+    void EncodeJpeg(const std::shared_ptr<IBuffer>& buffer, RkJpegCompressor& compressor, uint32_t quality,
+        uint32_t exifRotation);
+    bool EncodeJpegStrips(const std::shared_ptr<IBuffer>& buffer, uint32_t quality, uint32_t exifRotation);
+    void SetJpegResult(const std::shared_ptr<IBuffer>& buffer, size_t jpegSize);
+    void PrepareJpegFrame(std::shared_ptr<IBuffer>& buffer, uint32_t pixelRotation);
+    RkJpegSettings GetJpegSettings();
+    std::shared_ptr<RkZslRing> GetZslRing();
+    void SetZslCaptureSizeLocked();
+    void ReleaseMemory(int32_t streamId);
+    void Yuv420ToJpeg(std::shared_ptr<IBuffer>& buffer);
+    void SubmitJpegBurst(std::shared_ptr<IBuffer>& buffer);
+    void DrainJpegBurst();
+    void SubmitVideo(std::shared_ptr<IBuffer>& buffer);
+    void StopVideoPipeline();
+    void VideoConvert(RkCodecJob& job);
+    void VideoEncode(RkCodecJob& job);
+    void VideoOutput(RkCodecJob& job);
+
+    std::set<int32_t> streams_;     // started and not stopped yet, under g_codecStreamsLock
+    int32_t encodeStreamId_ = -1;
+    int32_t encodeSession_ = -1;    // session of encodeStreamId_ in RkEncoderService
+    int32_t videoEncodeType_ = ENCODE_TYPE_H264;
+    std::mutex jpegSettingsLock_;
+    RkJpegSettings jpegSettings_;
+    std::mutex jpegLock_;
+    RkJpegCompressor jpegCompressor_;
+    std::unique_ptr<RkJpegBurstPool> jpegStripPool_ = nullptr;   // used under jpegLock_
+    bool jpegBurst_ = false;
+    std::mutex jpegBurstLock_;
+    std::unique_ptr<RkJpegBurstPool> jpegBurstPool_ = nullptr;
+    std::mutex zslLock_;
+    std::shared_ptr<RkZslRing> zslRing_ = nullptr;   // nullptr while ZSL is off
+    uint32_t zslDepth_ = 0;
+    std::map<int32_t, std::pair<uint32_t, uint32_t>> stillStreams_;   // width and height by stream id
+    std::mutex pipelineLock_;
+    std::unique_ptr<RkCodecPipeline> videoPipeline_ = nullptr;
+    std::mutex videoRcLock_;
+    RkRateControl videoRc_;
+    std::vector<RkNalUnit> nalUnits_;   // only touched by the output stage
+};
+} // namespace OHOS::Camera
+#endif
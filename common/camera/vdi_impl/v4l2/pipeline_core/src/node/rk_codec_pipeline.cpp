@@ -0,0 +1,184 @@
+/*
+ * Copyright (c) 2024 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "rk_codec_pipeline.h"
+#include <ctime>
+#include "camera.h"
+#include "rk_trace.h"
+
+namespace OHOS::Camera {
+static constexpr int64_t TIME_CONVERSION_S_NS = 1000000000LL; /* s to ns */
+
+#ifdef RK_CAMERA_TRACE
+static constexpr const char* STAGE_TRACE_NAMES[] = {
+    "RkCodecPipeline convert", "RkCodecPipeline encode", "RkCodecPipeline output",
+};
+#endif
+
+static int64_t GetMonotonicTimeNs()
+{
+    struct timespec ts = {};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * TIME_CONVERSION_S_NS + ts.tv_nsec;
+}
+
+RkCodecPipeline::RkCodecPipeline(const std::string& name, uint32_t maxInFlight)
+    : name_(name), maxInFlight_(maxInFlight)
+{
+}
+
+RkCodecPipeline::~RkCodecPipeline()
+{
+    Stop();
+}
+
+void RkCodecPipeline::SetStage(Stage stage, StageFunc func, bool async)
+{
+    if (stage >= STAGE_COUNT || running_) {
+        return;
+    }
+    funcs_[stage] = func;
+    async_[stage] = async;
+}
+
+void RkCodecPipeline::Start()
+{
+    if (running_) {
+        return;
+    }
+    running_ = true;
+    for (uint32_t stage = 0; stage < STAGE_COUNT; stage++) {
+        threads_[stage] = std::thread([this, stage] { StageLoop(stage); });
+    }
+    CAMERA_LOGI("RkCodecPipeline %{public}s start, max in flight %{public}u", name_.c_str(), maxInFlight_);
+}
+
+void RkCodecPipeline::Stop()
+{
+    if (!running_) {
+        return;
+    }
+    Drain();
+    running_ = false;
+    for (uint32_t stage = 0; stage < STAGE_COUNT; stage++) {
+        {
+            std::lock_guard<std::mutex> l(queues_[stage].lock);
+            queues_[stage].cv.notify_all();
+        }
+        if (threads_[stage].joinable()) {
+            threads_[stage].join();
+        }
+    }
+    CAMERA_LOGI("RkCodecPipeline %{public}s stop, submitted %{public}llu dropped %{public}llu",
+        name_.c_str(), static_cast<unsigned long long>(submitted_), static_cast<unsigned long long>(dropped_));
+}
+
+void RkCodecPipeline::Drain()
+{
+    std::unique_lock<std::mutex> l(countLock_);
+    drainCv_.wait(l, [this] { return pending_ == 0; });
+}
+
+void RkCodecPipeline::Submit(const std::shared_ptr<IBuffer>& buffer)
+{
+    RkCodecJob job;
+    job.buffer = buffer;
+    job.timestamp = GetMonotonicTimeNs();
+    {
+        std::lock_guard<std::mutex> l(countLock_);
+        job.sequence = submitted_++;
+        pending_++;
+        if (inFlight_ >= maxInFlight_) {
+            job.dropped = true;
+            dropped_++;
+            CAMERA_LOGW("RkCodecPipeline %{public}s full, drop frame index %{public}d",
+                name_.c_str(), buffer->GetIndex());
+        } else {
+            inFlight_++;
+        }
+        RK_TRACE_COUNTER("RkCodecPipeline in flight", inFlight_);
+    }
+    if (job.dropped) {
+        buffer->SetBufferStatus(CAMERA_BUFFER_STATUS_DROP);
+    }
+    Push(STAGE_CONVERT, std::move(job));
+}
+
+void RkCodecPipeline::Forward(Stage stage, RkCodecJob&& job)
+{
+    if (stage + 1 < STAGE_COUNT) {
+        Push(stage + 1, std::move(job));
+        return;
+    }
+    CAMERA_LOGD("RkCodecPipeline %{public}s frame index %{public}d latency %{public}lld ns",
+        name_.c_str(), job.buffer->GetIndex(), static_cast<long long>(GetMonotonicTimeNs() - job.timestamp));
+    Finish(job);
+}
+
+void RkCodecPipeline::Push(uint32_t stage, RkCodecJob&& job)
+{
+    std::lock_guard<std::mutex> l(queues_[stage].lock);
+    if (stage != STAGE_OUTPUT) {
+        queues_[stage].jobs.push_back(std::move(job));
+        queues_[stage].cv.notify_one();
+        return;
+    }
+    // a dropped or failed frame must not overtake the frames before it that are still encoding
+    reorder_.emplace(job.sequence, std::move(job));
+    while (!reorder_.empty() && reorder_.begin()->first == nextOutput_) {
+        queues_[stage].jobs.push_back(std::move(reorder_.begin()->second));
+        reorder_.erase(reorder_.begin());
+        nextOutput_++;
+    }
+    queues_[stage].cv.notify_one();
+}
+
+void RkCodecPipeline::Finish(const RkCodecJob& job)
+{
+    std::lock_guard<std::mutex> l(countLock_);
+    if (!job.dropped) {
+        inFlight_--;
+    }
+    pending_--;
+    if (pending_ == 0) {
+        drainCv_.notify_all();
+    }
+}
+
+void RkCodecPipeline::StageLoop(uint32_t stage)
+{
+    StageQueue& queue = queues_[stage];
+    while (true) {
+        RkCodecJob job;
+        {
+            std::unique_lock<std::mutex> l(queue.lock);
+            queue.cv.wait(l, [this, &queue] { return !running_ || !queue.jobs.empty(); });
+            if (queue.jobs.empty()) {
+                break;
+            }
+            job = std::move(queue.jobs.front());
+            queue.jobs.pop_front();
+        }
+
+        bool runStage = stage == STAGE_OUTPUT || !job.dropped;
+        if (runStage && funcs_[stage]) {
+            RK_TRACE_SCOPE(STAGE_TRACE_NAMES[stage], job.buffer);
+            funcs_[stage](job);
+            if (async_[stage]) {
+                continue;
+            }
+        }
+        Forward(static_cast<Stage>(stage), std::move(job));
+    }
+}
+} // namespace OHOS::Camera
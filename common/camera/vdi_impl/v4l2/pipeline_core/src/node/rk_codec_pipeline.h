@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2024 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HOS_CAMERA_RK_CODEC_PIPELINE_H
+#define HOS_CAMERA_RK_CODEC_PIPELINE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "ibuffer.h"
+
+namespace OHOS::Camera {
+struct RkCodecJob {
+    std::shared_ptr<IBuffer> buffer = nullptr;
+    int64_t timestamp = 0;    // CLOCK_MONOTONIC ns when the frame entered the node
+    uint64_t sequence = 0;    // submission order
+    size_t esSize = 0;
+    bool dropped = false;
+};
+
+/*
+ * A bounded, ordered convert -> encode -> output pipeline. Every stage runs on its own thread and
+ * handles jobs in submission order, so frames leave the pipeline in the order they came in.
+ * When maxInFlight frames are already being worked on, a new frame is marked dropped: it skips the
+ * convert and encode stages but still reaches the output stage in order, so the buffer goes back
+ * to its pool without stalling the delivering thread.
+ * An asynchronous stage only starts the work of a job; whoever completes it hands the job on with
+ * Forward. Jobs that skip or fail a stage can come back before the ones still in it, so the output
+ * stage takes them in submission order.
+ */
+class RkCodecPipeline {
+public:
+    enum Stage : uint32_t {
+        STAGE_CONVERT = 0,
+        STAGE_ENCODE,
+        STAGE_OUTPUT,
+        STAGE_COUNT,
+    };
+    using StageFunc = std::function<void(RkCodecJob&)>;
+
+    RkCodecPipeline(const std::string& name, uint32_t maxInFlight);
+    ~RkCodecPipeline();
+    RkCodecPipeline(const RkCodecPipeline&) = delete;
+    RkCodecPipeline& operator=(const RkCodecPipeline&) = delete;
+
+    void SetStage(Stage stage, StageFunc func, bool async = false);
+    void Start();
+    void Stop();
+    void Drain();
+    void Submit(const std::shared_ptr<IBuffer>& buffer);
+    // passes a job an asynchronous stage has completed to the next stage
+    void Forward(Stage stage, RkCodecJob&& job);
+
+private:
+    struct StageQueue {
+        std::mutex lock;
+        std::condition_variable cv;
+        std::deque<RkCodecJob> jobs;
+    };
+
+    void StageLoop(uint32_t stage);
+    void Push(uint32_t stage, RkCodecJob&& job);
+    void Finish(const RkCodecJob& job);
+
+    std::string name_;
+    uint32_t maxInFlight_;
+    StageQueue queues_[STAGE_COUNT];
+    StageFunc funcs_[STAGE_COUNT];
+    bool async_[STAGE_COUNT] = {};
+    std::thread threads_[STAGE_COUNT];
+    std::map<uint64_t, RkCodecJob> reorder_;   // jobs that reached the output stage ahead of their turn
+    uint64_t nextOutput_ = 0;                   // both under the lock of the output queue
+    std::atomic<bool> running_ = false;
+
+    std::mutex countLock_;
+    std::condition_variable drainCv_;
+    uint32_t inFlight_ = 0;
+    uint32_t pending_ = 0;
+    uint64_t submitted_ = 0;
+    uint64_t dropped_ = 0;
+};
+} // namespace OHOS::Camera
+#endif
@@ -0,0 +1,691 @@
+/*
+ * Copyright (c) 2024 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "rk_cpu_blit.h"
+#include <algorithm>
+#include <cstring>
+
+namespace OHOS::Camera {
+static constexpr uint32_t MAX_BLIT_THREADS = 4;      // 4:threads including the caller
+static constexpr uint32_t BANDS_PER_THREAD = 2;      // 2:bands per thread, evens out uneven bands
+static constexpr uint32_t MIN_BAND_ROWS = 16;        // 16:rows below which splitting costs more than it saves
+static constexpr uint32_t FIXED_SHIFT = 16;          // 16.16 fixed point source coordinates
+static constexpr uint32_t WEIGHT_SHIFT = 8;          // 8-bit bilinear weights
+static constexpr uint32_t WEIGHT_ONE = 1 << WEIGHT_SHIFT;
+static constexpr uint32_t RGB_BPP = 3;
+static constexpr uint32_t RGBA_BPP = 4;
+static constexpr uint32_t VEC_PIXELS = 8;            // 8:pixels per vector step
+static constexpr uint32_t ROTATE_TILE = 8;           // 8:rows and columns of a rotation tile, one 64 byte vector
+static constexpr uint32_t MAX_PLANES = 3;
+
+typedef int32_t RkI32x8 __attribute__((vector_size(32)));
+typedef uint8_t RkU8x8 __attribute__((vector_size(8)));
+typedef uint8_t RkU8x4 __attribute__((vector_size(4)));
+typedef uint8_t RkU8x16 __attribute__((vector_size(16)));
+typedef uint8_t RkU8x32 __attribute__((vector_size(32)));
+typedef uint8_t RkU8x64 __attribute__((vector_size(64)));
+typedef uint16_t RkU16x8 __attribute__((vector_size(16)));
+
+RkBlitWorkers& RkBlitWorkers::GetInstance()
+{
+    static RkBlitWorkers instance;
+    return instance;
+}
+
+RkBlitWorkers::RkBlitWorkers()
+{
+    uint32_t count = std::clamp(std::thread::hardware_concurrency(), 1U, MAX_BLIT_THREADS);
+    for (uint32_t i = 1; i < count; i++) {
+        threads_.emplace_back([this] { WorkerLoop(); });
+    }
+}
+
+RkBlitWorkers::~RkBlitWorkers()
+{
+    {
+        std::lock_guard<std::mutex> l(lock_);
+        exit_ = true;
+    }
+    cv_.notify_all();
+    for (auto& thread : threads_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+}
+
+bool RkBlitWorkers::RunBand()
+{
+    uint32_t begin = next_.fetch_add(band_);
+    if (begin >= count_) {
+        return false;
+    }
+    (*func_)(begin, std::min(begin + band_, count_));
+    return true;
+}
+
+void RkBlitWorkers::WorkerLoop()
+{
+    uint64_t seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> l(lock_);
+            cv_.wait(l, [this, seen] { return exit_ || generation_ != seen; });
+            if (exit_) {
+                return;
+            }
+            seen = generation_;
+        }
+        while (RunBand()) {
+        }
+        std::lock_guard<std::mutex> l(lock_);
+        if (--active_ == 0) {
+            doneCv_.notify_all();
+        }
+    }
+}
+
+void RkBlitWorkers::ParallelFor(uint32_t count, uint32_t minBand, const BandFunc& func)
+{
+    if (count == 0) {
+        return;
+    }
+    std::unique_lock<std::mutex> owner(ownerLock_, std::try_to_lock);
+    if (!owner.owns_lock() || threads_.empty() || count <= minBand) {
+        func(0, count);
+        return;
+    }
+
+    uint32_t bands = (threads_.size() + 1) * BANDS_PER_THREAD;
+    {
+        std::lock_guard<std::mutex> l(lock_);
+        func_ = &func;
+        count_ = count;
+        band_ = std::max(minBand, (count + bands - 1) / bands);
+        next_ = 0;
+        active_ = threads_.size();
+        generation_++;
+    }
+    cv_.notify_all();
+    while (RunBand()) {
+    }
+    std::unique_lock<std::mutex> l(lock_);
+    doneCv_.wait(l, [this] { return active_ == 0; });
+    func_ = nullptr;
+}
+
+namespace {
+struct RkPlane {
+    uint8_t* data;
+    uint32_t width;
+    uint32_t height;
+    uint32_t channels;      // interleaved samples per pixel, rows are width * channels bytes
+};
+}
+
+static bool IsYuv(int32_t rkFmt)
+{
+    return rkFmt == RK_FORMAT_YCbCr_420_SP || rkFmt == RK_FORMAT_YCbCr_420_P;
+}
+
+static uint32_t GetRgbBpp(int32_t rkFmt)
+{
+    return rkFmt == RK_FORMAT_RGBA_8888 ? RGBA_BPP : RGB_BPP;
+}
+
+// 4:2:0 needs at least one chroma sample
+static uint32_t MinSize(int32_t rkFmt)
+{
+    return IsYuv(rkFmt) ? 2 : 1; // 2:luma pixels per chroma sample
+}
+
+static size_t GetImageSize(uint32_t width, uint32_t height, int32_t rkFmt)
+{
+    if (IsYuv(rkFmt)) {
+        return static_cast<size_t>(width) * height + 2 * static_cast<size_t>(width / 2) * (height / 2); // 2:Cb Cr
+    }
+    return static_cast<size_t>(width) * height * GetRgbBpp(rkFmt);
+}
+
+static uint32_t GetPlanes(uint8_t* base, uint32_t width, uint32_t height, int32_t rkFmt, RkPlane planes[MAX_PLANES])
+{
+    const uint32_t chromaWidth = width / 2;
+    const uint32_t chromaHeight = height / 2;
+    uint8_t* chroma = base + static_cast<size_t>(width) * height;
+    if (rkFmt == RK_FORMAT_YCbCr_420_SP) {
+        planes[0] = {base, width, height, 1};
+        planes[1] = {chroma, chromaWidth, chromaHeight, 2}; // 2:Cb Cr interleaved
+        return 2; // 2:Y and CbCr planes
+    }
+    if (rkFmt == RK_FORMAT_YCbCr_420_P) {
+        planes[0] = {base, width, height, 1};
+        planes[1] = {chroma, chromaWidth, chromaHeight, 1};
+        planes[2] = {chroma + static_cast<size_t>(chromaWidth) * chromaHeight, chromaWidth, chromaHeight, 1};
+        return MAX_PLANES;
+    }
+    planes[0] = {base, width, height, GetRgbBpp(rkFmt)};
+    return 1;
+}
+
+// blends two source rows into 16-bit samples, eight per vector step; 255 * 256 still fits
+static void BlendRows(const uint8_t* row0, const uint8_t* row1, uint32_t fy, uint16_t* out, uint32_t count)
+{
+    const uint16_t w0 = WEIGHT_ONE - fy;
+    const uint16_t w1 = fy;
+    uint32_t i = 0;
+    for (; i + VEC_PIXELS <= count; i += VEC_PIXELS) {
+        RkU8x8 a;
+        RkU8x8 b;
+        (void)memcpy(&a, row0 + i, sizeof(a));
+        (void)memcpy(&b, row1 + i, sizeof(b));
+        RkU16x8 v = __builtin_convertvector(a, RkU16x8) * w0 + __builtin_convertvector(b, RkU16x8) * w1;
+        (void)memcpy(out + i, &v, sizeof(v));
+    }
+    for (; i < count; i++) {
+        out[i] = row0[i] * w0 + row1[i] * w1;
+    }
+}
+
+/*
+ * Bilinear is separable: each row first blends its two source rows, then neighbouring samples of the
+ * blend, eight destination samples per vector step. Without rounding in between this gives the same
+ * result as blending the columns first. The column tables are kept in tables and the blended row in a
+ * slab of every thread, so a scale allocates nothing once its sizes have been seen.
+ */
+static RetCode ScalePlane(const RkPlane& src, const RkPlane& dst, RkPoolBuffer& tables)
+{
+    const uint32_t ch = src.channels;
+    const uint32_t srcStride = src.width * ch;
+    const uint32_t dstStride = dst.width * ch;
+    const uint32_t xStep = (src.width << FIXED_SHIFT) / dst.width;
+    const uint32_t yStep = (src.height << FIXED_SHIFT) / dst.height;
+    const int64_t half = 1 << (FIXED_SHIFT - 1);
+
+    // source samples and weight of every destination sample, pixel centres aligned
+    RkBufferPool::GetInstance().Reserve(tables, 3 * sizeof(uint32_t) * dstStride); // 3:index0, index1, weight
+    if (tables.GetData() == nullptr) {
+        CAMERA_LOGE("RkCpuBlitBackend ScalePlane out of memory for %{public}u samples", dstStride);
+        return RC_ERROR;
+    }
+    uint32_t* index0 = reinterpret_cast<uint32_t*>(tables.GetData());
+    uint32_t* index1 = index0 + dstStride;
+    int32_t* weight = reinterpret_cast<int32_t*>(index1 + dstStride);
+    for (uint32_t x = 0; x < dst.width; x++) {
+        int64_t sx = std::max<int64_t>(static_cast<int64_t>(x) * xStep + xStep / 2 - half, 0);
+        uint32_t x0 = std::min<uint32_t>(sx >> FIXED_SHIFT, src.width - 1);
+        uint32_t x1 = std::min(x0 + 1, src.width - 1);
+        for (uint32_t c = 0; c < ch; c++) {
+            index0[x * ch + c] = x0 * ch + c;
+            index1[x * ch + c] = x1 * ch + c;
+            weight[x * ch + c] = (sx >> (FIXED_SHIFT - WEIGHT_SHIFT)) & (WEIGHT_ONE - 1);
+        }
+    }
+
+    std::atomic<bool> failed = false;
+    RkBlitWorkers::GetInstance().ParallelFor(dst.height, MIN_BAND_ROWS, [&](uint32_t begin, uint32_t end) {
+        const int32_t one = WEIGHT_ONE;
+        const int32_t round = 1 << (2 * WEIGHT_SHIFT - 1); // 2, 1:rounding of the 2x8 bit blend
+        static thread_local RkPoolBuffer blendRow;
+        RkBufferPool::GetInstance().Reserve(blendRow, sizeof(uint16_t) * srcStride);
+        uint16_t* blend = reinterpret_cast<uint16_t*>(blendRow.GetData());
+        if (blend == nullptr) {
+            CAMERA_LOGE("RkCpuBlitBackend ScalePlane out of memory for %{public}u samples", srcStride);
+            failed = true;
+            return;
+        }
+        for (uint32_t y = begin; y < end; y++) {
+            int64_t sy = std::max<int64_t>(static_cast<int64_t>(y) * yStep + yStep / 2 - half, 0);
+            uint32_t y0 = std::min<uint32_t>(sy >> FIXED_SHIFT, src.height - 1);
+            uint32_t y1 = std::min(y0 + 1, src.height - 1);
+            BlendRows(src.data + static_cast<size_t>(y0) * srcStride, src.data + static_cast<size_t>(y1) * srcStride,
+                (sy >> (FIXED_SHIFT - WEIGHT_SHIFT)) & (WEIGHT_ONE - 1), blend, srcStride);
+            uint8_t* out = dst.data + static_cast<size_t>(y) * dstStride;
+            uint32_t k = 0;
+            for (; k + VEC_PIXELS <= dstStride; k += VEC_PIXELS) {
+                RkI32x8 a;
+                RkI32x8 b;
+                RkI32x8 w;
+                for (uint32_t i = 0; i < VEC_PIXELS; i++) {
+                    a[i] = blend[index0[k + i]];
+                    b[i] = blend[index1[k + i]];
+                }
+                (void)memcpy(&w, weight + k, sizeof(w));
+                RkU8x8 v = __builtin_convertvector((a * (one - w) + b * w + round) >> (2 * WEIGHT_SHIFT), RkU8x8);
+                (void)memcpy(out + k, &v, sizeof(v));
+            }
+            for (; k < dstStride; k++) {
+                out[k] = (blend[index0[k]] * (one - weight[k]) + blend[index1[k]] * weight[k] + round) >>
+                    (2 * WEIGHT_SHIFT); // 2:2x8 bit blend
+            }
+        }
+    });
+    return failed ? RC_ERROR : RC_OK;
+}
+
+// shuffle indices of row i of an 8x8 tile rotated clockwise, the source tile is loaded row by row
+#define RK_ROT90_ROW(i) 56 + (i), 48 + (i), 40 + (i), 32 + (i), 24 + (i), 16 + (i), 8 + (i), (i)
+#define RK_ROT180_ROW(i) 63 - 8 * (i), 62 - 8 * (i), 61 - 8 * (i), 60 - 8 * (i), \
+    59 - 8 * (i), 58 - 8 * (i), 57 - 8 * (i), 56 - 8 * (i)
+#define RK_ROT270_ROW(i) 7 - (i), 15 - (i), 23 - (i), 31 - (i), 39 - (i), 47 - (i), 55 - (i), 63 - (i)
+#define RK_TILE_ROWS(row) row(0), row(1), row(2), row(3), row(4), row(5), row(6), row(7)
+
+// rotates one 8x8 tile of a single channel plane with a single shuffle
+static inline void RotateTile(const uint8_t* in, uint32_t inStride, uint8_t* out, uint32_t outStride,
+    int32_t rotation)
+{
+    RkU8x64 tile;
+    for (uint32_t r = 0; r < ROTATE_TILE; r++) {
+        (void)memcpy(reinterpret_cast<uint8_t*>(&tile) + r * ROTATE_TILE, in + r * inStride, ROTATE_TILE);
+    }
+    RkU8x64 rotated;
+    if (rotation == HAL_TRANSFORM_ROT_90) {
+        rotated = __builtin_shufflevector(tile, tile, RK_TILE_ROWS(RK_ROT90_ROW));
+    } else if (rotation == HAL_TRANSFORM_ROT_180) {
+        rotated = __builtin_shufflevector(tile, tile, RK_TILE_ROWS(RK_ROT180_ROW));
+    } else {
+        rotated = __builtin_shufflevector(tile, tile, RK_TILE_ROWS(RK_ROT270_ROW));
+    }
+    for (uint32_t r = 0; r < ROTATE_TILE; r++) {
+        (void)memcpy(out + r * outStride, reinterpret_cast<uint8_t*>(&rotated) + r * ROTATE_TILE, ROTATE_TILE);
+    }
+}
+
+static inline const uint8_t* RotateSource(const RkPlane& src, int32_t rotation, uint32_t x, uint32_t y)
+{
+    uint32_t sx = src.width - 1 - y;
+    uint32_t sy = x;
+    if (rotation == HAL_TRANSFORM_ROT_90) {
+        sx = y;
+        sy = src.height - 1 - x;
+    } else if (rotation == HAL_TRANSFORM_ROT_180) {
+        sx = src.width - 1 - x;
+        sy = src.height - 1 - y;
+    }
+    return src.data + (static_cast<size_t>(sy) * src.width + sx) * src.channels;
+}
+
+/*
+ * Walks the destination in 8x8 tiles. Single channel planes, Y and the I420 chroma, rotate whole tiles
+ * in vector registers, the edges and interleaved planes go pixel by pixel.
+ */
+static void RotatePlane(const RkPlane& src, const RkPlane& dst, int32_t rotation)
+{
+    const uint32_t ch = src.channels;
+    const uint32_t tileRows = (dst.height + ROTATE_TILE - 1) / ROTATE_TILE;
+    const uint32_t minBand = MIN_BAND_ROWS / ROTATE_TILE;
+    RkBlitWorkers::GetInstance().ParallelFor(tileRows, minBand, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t ty = begin; ty < end; ty++) {
+            const uint32_t y0 = ty * ROTATE_TILE;
+            const uint32_t y1 = std::min(y0 + ROTATE_TILE, dst.height);
+            uint32_t tiled = 0;
+            for (; ch == 1 && y1 - y0 == ROTATE_TILE && tiled + ROTATE_TILE <= dst.width; tiled += ROTATE_TILE) {
+                // the source tile starts at the source of the destination corner that maps to its top left
+                uint32_t cornerX = rotation == HAL_TRANSFORM_ROT_270 ? tiled : tiled + ROTATE_TILE - 1;
+                uint32_t cornerY = rotation == HAL_TRANSFORM_ROT_90 ? y0 : y1 - 1;
+                RotateTile(RotateSource(src, rotation, cornerX, cornerY), src.width,
+                    dst.data + static_cast<size_t>(y0) * dst.width + tiled, dst.width, rotation);
+            }
+            for (uint32_t y = y0; y < y1; y++) {
+                uint8_t* out = dst.data + static_cast<size_t>(y) * dst.width * ch;
+                for (uint32_t x = tiled; x < dst.width; x++) {
+                    const uint8_t* in = RotateSource(src, rotation, x, y);
+                    for (uint32_t c = 0; c < ch; c++) {
+                        out[x * ch + c] = in[c];
+                    }
+                }
+            }
+        }
+    });
+}
+
+// clamps every lane to [0, 255] without branches or compares
+static inline RkU8x8 Clamp255(const RkI32x8& value)
+{
+    RkI32x8 v = value & ~(value >> 31);     // 31:sign, negative lanes become 0
+    v = v | ((255 - v) >> 31);              // 255, 31:lanes above 255 become all ones
+    return __builtin_convertvector(v & 255, RkU8x8); // 255:max sample
+}
+
+static inline void YuvToRgbScalar(int32_t y, int32_t u, int32_t v, uint8_t* out)
+{
+    // BT.601 limited range, 8 bit fixed point
+    int32_t c = (y - 16) * 298;     // 16, 298:luma offset and gain
+    int32_t d = u - 128;            // 128:chroma offset
+    int32_t e = v - 128;            // 128:chroma offset
+    out[0] = std::clamp((c + 409 * e + 128) >> 8, 0, 255);             // 409, 128, 8, 255:R
+    out[1] = std::clamp((c - 100 * d - 208 * e + 128) >> 8, 0, 255);   // 100, 208, 128, 8, 255:G
+    out[2] = std::clamp((c + 516 * d + 128) >> 8, 0, 255);             // 2, 516, 128, 8, 255:B
+}
+
+// one row of 4:2:0 YUV to RGB888 or RGBA8888; chromaStep is 1 for I420 and 2 for NV12
+static void RowYuvToRgb(const uint8_t* yRow, const uint8_t* uRow, const uint8_t* vRow, uint32_t chromaStep,
+    uint8_t* out, uint32_t width, uint32_t bpp)
+{
+    uint32_t x = 0;
+    for (; x + VEC_PIXELS <= width; x += VEC_PIXELS) {
+        RkU8x8 y8;
+        RkU8x8 u8;
+        RkU8x8 v8;
+        (void)memcpy(&y8, yRow + x, sizeof(y8));
+        if (chromaStep == 1) {
+            RkU8x4 u4;
+            RkU8x4 v4;
+            (void)memcpy(&u4, uRow + x / 2, sizeof(u4));
+            (void)memcpy(&v4, vRow + x / 2, sizeof(v4));
+            u8 = __builtin_shufflevector(u4, u4, 0, 0, 1, 1, 2, 2, 3, 3);
+            v8 = __builtin_shufflevector(v4, v4, 0, 0, 1, 1, 2, 2, 3, 3);
+        } else {
+            RkU8x8 uv;
+            (void)memcpy(&uv, uRow + x, sizeof(uv));
+            u8 = __builtin_shufflevector(uv, uv, 0, 0, 2, 2, 4, 4, 6, 6);
+            v8 = __builtin_shufflevector(uv, uv, 1, 1, 3, 3, 5, 5, 7, 7);
+        }
+        RkI32x8 c = (__builtin_convertvector(y8, RkI32x8) - 16) * 298;     // 16, 298:luma offset and gain
+        RkI32x8 d = __builtin_convertvector(u8, RkI32x8) - 128;            // 128:chroma offset
+        RkI32x8 e = __builtin_convertvector(v8, RkI32x8) - 128;            // 128:chroma offset
+        RkU8x8 r = Clamp255((c + 409 * e + 128) >> 8);             // 409, 128, 8:R
+        RkU8x8 g = Clamp255((c - 100 * d - 208 * e + 128) >> 8);   // 100, 208, 128, 8:G
+        RkU8x8 b = Clamp255((c + 516 * d + 128) >> 8);             // 516, 128, 8:B
+        uint8_t* dst = out + x * bpp;
+        for (uint32_t i = 0; i < VEC_PIXELS; i++, dst += bpp) {
+            dst[0] = r[i];
+            dst[1] = g[i];
+            dst[2] = b[i]; // 2:B
+            if (bpp == RGBA_BPP) {
+                dst[3] = 255; // 3, 255:opaque alpha
+            }
+        }
+    }
+    for (; x < width; x++) {
+        uint8_t* dst = out + x * bpp;
+        uint32_t cx = std::min(x / 2, width / 2 - 1); // the last column of an odd width shares the last chroma
+        YuvToRgbScalar(yRow[x], uRow[cx * chromaStep], vRow[cx * chromaStep], dst);
+        if (bpp == RGBA_BPP) {
+            dst[3] = 255; // 3, 255:opaque alpha
+        }
+    }
+}
+
+static void ConvertYuvToRgb(const RkPlane* src, int32_t srcFmt, const RkPlane& dst)
+{
+    const uint8_t* uBase = src[1].data;
+    const uint8_t* vBase = srcFmt == RK_FORMAT_YCbCr_420_SP ? src[1].data + 1 : src[2].data; // 2:Cr plane
+    const uint32_t chromaStep = src[1].channels;
+    const uint32_t chromaStride = src[1].width * src[1].channels;
+    RkBlitWorkers::GetInstance().ParallelFor(dst.height, MIN_BAND_ROWS, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t y = begin; y < end; y++) {
+            size_t chromaOffset = static_cast<size_t>(std::min(y / 2, src[1].height - 1)) * chromaStride;
+            RowYuvToRgb(src[0].data + static_cast<size_t>(y) * src[0].width, uBase + chromaOffset,
+                vBase + chromaOffset, chromaStep, dst.data + static_cast<size_t>(y) * dst.width * dst.channels,
+                dst.width, dst.channels);
+        }
+    });
+}
+
+// deinterleaves eight RGB888 or RGBA8888 pixels into 32-bit lanes
+template <uint32_t BPP>
+static inline void LoadRgb(const uint8_t* in, RkI32x8& r, RkI32x8& g, RkI32x8& b)
+{
+    RkU8x32 px = {};
+    (void)memcpy(&px, in, BPP * VEC_PIXELS);
+    if constexpr (BPP == RGBA_BPP) {
+        r = __builtin_convertvector(__builtin_shufflevector(px, px, 0, 4, 8, 12, 16, 20, 24, 28), RkI32x8);
+        g = __builtin_convertvector(__builtin_shufflevector(px, px, 1, 5, 9, 13, 17, 21, 25, 29), RkI32x8);
+        b = __builtin_convertvector(__builtin_shufflevector(px, px, 2, 6, 10, 14, 18, 22, 26, 30), RkI32x8);
+    } else {
+        r = __builtin_convertvector(__builtin_shufflevector(px, px, 0, 3, 6, 9, 12, 15, 18, 21), RkI32x8);
+        g = __builtin_convertvector(__builtin_shufflevector(px, px, 1, 4, 7, 10, 13, 16, 19, 22), RkI32x8);
+        b = __builtin_convertvector(__builtin_shufflevector(px, px, 2, 5, 8, 11, 14, 17, 20, 23), RkI32x8);
+    }
+}
+
+// sums the horizontal pixel pairs of sixteen pixels into eight lanes
+static inline RkI32x8 PairSum(const RkI32x8& lo, const RkI32x8& hi)
+{
+    return __builtin_shufflevector(lo, hi, 0, 2, 4, 6, 8, 10, 12, 14) +
+        __builtin_shufflevector(lo, hi, 1, 3, 5, 7, 9, 11, 13, 15);
+}
+
+static inline uint8_t RgbToY(int32_t r, int32_t g, int32_t b)
+{
+    return ((66 * r + 129 * g + 25 * b + 128) >> 8) + 16; // BT.601 limited range
+}
+
+static inline uint8_t RgbToU(int32_t r, int32_t g, int32_t b)
+{
+    return ((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128; // BT.601
+}
+
+static inline uint8_t RgbToV(int32_t r, int32_t g, int32_t b)
+{
+    return ((112 * r - 94 * g - 18 * b + 128) >> 8) + 128; // BT.601
+}
+
+template <uint32_t BPP>
+static void RowRgbToY(const uint8_t* in, uint8_t* out, uint32_t width)
+{
+    uint32_t x = 0;
+    for (; x + VEC_PIXELS <= width; x += VEC_PIXELS) {
+        RkI32x8 r;
+        RkI32x8 g;
+        RkI32x8 b;
+        LoadRgb<BPP>(in + x * BPP, r, g, b);
+        RkU8x8 y = __builtin_convertvector(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16, RkU8x8); // BT.601
+        (void)memcpy(out + x, &y, sizeof(y));
+    }
+    for (; x < width; x++) {
+        const uint8_t* px = in + x * BPP;
+        out[x] = RgbToY(px[0], px[1], px[2]); // 2:B
+    }
+}
+
+// one chroma row from the 2x2 averages of two RGB rows; chromaStep is 1 for I420 and 2 for NV12
+template <uint32_t BPP>
+static void RowRgbToUv(const uint8_t* row0, const uint8_t* row1, uint8_t* u, uint8_t* v, uint32_t chromaStep,
+    uint32_t chromaWidth)
+{
+    uint32_t cx = 0;
+    for (; cx + VEC_PIXELS <= chromaWidth; cx += VEC_PIXELS) {
+        const size_t lo = static_cast<size_t>(cx) * 2 * BPP;  // 2:two luma columns per chroma column
+        const size_t hi = lo + VEC_PIXELS * BPP;
+        RkI32x8 r[4];   // 4:low and high eight pixels of both rows
+        RkI32x8 g[4];   // 4:low and high eight pixels of both rows
+        RkI32x8 b[4];   // 4:low and high eight pixels of both rows
+        LoadRgb<BPP>(row0 + lo, r[0], g[0], b[0]);
+        LoadRgb<BPP>(row0 + hi, r[1], g[1], b[1]);
+        LoadRgb<BPP>(row1 + lo, r[2], g[2], b[2]); // 2:second row, low pixels
+        LoadRgb<BPP>(row1 + hi, r[3], g[3], b[3]); // 3:second row, high pixels
+        RkI32x8 ra = (PairSum(r[0], r[1]) + PairSum(r[2], r[3]) + 2) >> 2; // 2, 3:average of 2x2
+        RkI32x8 ga = (PairSum(g[0], g[1]) + PairSum(g[2], g[3]) + 2) >> 2; // 2, 3:average of 2x2
+        RkI32x8 ba = (PairSum(b[0], b[1]) + PairSum(b[2], b[3]) + 2) >> 2; // 2, 3:average of 2x2
+        RkU8x8 u8 = __builtin_convertvector(((-38 * ra - 74 * ga + 112 * ba + 128) >> 8) + 128, RkU8x8); // BT.601
+        RkU8x8 v8 = __builtin_convertvector(((112 * ra - 94 * ga - 18 * ba + 128) >> 8) + 128, RkU8x8);  // BT.601
+        if (chromaStep == 1) {
+            (void)memcpy(u + cx, &u8, sizeof(u8));
+            (void)memcpy(v + cx, &v8, sizeof(v8));
+        } else {
+            RkU8x16 uv = __builtin_shufflevector(u8, v8, 0, 8, 1, 9, 2, 10, 3, 11, 4, 12, 5, 13, 6, 14, 7, 15);
+            (void)memcpy(u + static_cast<size_t>(cx) * 2, &uv, sizeof(uv)); // 2:CbCr pairs
+        }
+    }
+    for (; cx < chromaWidth; cx++) {
+        int32_t rgb[RGB_BPP] = {};
+        for (uint32_t c = 0; c < RGB_BPP; c++) {
+            size_t i = cx * 2 * BPP + c; // 2:two luma columns per chroma column
+            rgb[c] = (row0[i] + row0[i + BPP] + row1[i] + row1[i + BPP] + 2) >> 2; // 2:average of 2x2
+        }
+        u[cx * chromaStep] = RgbToU(rgb[0], rgb[1], rgb[2]); // 2:B
+        v[cx * chromaStep] = RgbToV(rgb[0], rgb[1], rgb[2]); // 2:B
+    }
+}
+
+template <uint32_t BPP>
+static void ConvertRgbToYuvRows(const RkPlane& src, const RkPlane* dst, int32_t dstFmt)
+{
+    const uint32_t width = src.width;
+    const uint32_t chromaStep = dstFmt == RK_FORMAT_YCbCr_420_SP ? 2 : 1; // 2:CbCr pairs
+    RkBlitWorkers::GetInstance().ParallelFor(dst[1].height, MIN_BAND_ROWS / 2, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t cy = begin; cy < end; cy++) {
+            const uint8_t* row0 = src.data + static_cast<size_t>(cy * 2) * width * BPP; // 2:two luma rows
+            const uint8_t* row1 = row0 + width * BPP;
+            uint8_t* out = dst[0].data + static_cast<size_t>(cy * 2) * width; // 2:two luma rows
+            RowRgbToY<BPP>(row0, out, width);
+            RowRgbToY<BPP>(row1, out + width, width);
+            uint8_t* u = dst[1].data + static_cast<size_t>(cy) * dst[1].width * chromaStep;
+            uint8_t* v = chromaStep == 1 ? dst[2].data + static_cast<size_t>(cy) * dst[2].width : u + 1; // 2:Cr
+            RowRgbToUv<BPP>(row0, row1, u, v, chromaStep, dst[1].width);
+        }
+    });
+    // the last row of an odd height has luma only, 4:2:0 chroma covers whole row pairs
+    if (src.height % 2 != 0) {
+        RowRgbToY<BPP>(src.data + static_cast<size_t>(src.height - 1) * width * BPP,
+            dst[0].data + static_cast<size_t>(src.height - 1) * width, width);
+    }
+}
+
+static void ConvertRgbToYuv(const RkPlane& src, const RkPlane* dst, int32_t dstFmt)
+{
+    if (src.channels == RGBA_BPP) {
+        ConvertRgbToYuvRows<RGBA_BPP>(src, dst, dstFmt);
+    } else {
+        ConvertRgbToYuvRows<RGB_BPP>(src, dst, dstFmt);
+    }
+}
+
+static void ConvertChroma(const RkPlane* src, int32_t srcFmt, const RkPlane* dst)
+{
+    const size_t count = static_cast<size_t>(src[1].width) * src[1].height;
+    if (srcFmt == RK_FORMAT_YCbCr_420_SP) {
+        const uint8_t* uv = src[1].data;
+        for (size_t i = 0; i < count; i++) {
+            dst[1].data[i] = uv[i * 2];         // 2:CbCr pairs
+            dst[2].data[i] = uv[i * 2 + 1];     // 2:Cr plane, CbCr pairs
+        }
+        return;
+    }
+    uint8_t* uv = dst[1].data;
+    for (size_t i = 0; i < count; i++) {
+        uv[i * 2] = src[1].data[i];             // 2:CbCr pairs
+        uv[i * 2 + 1] = src[2].data[i];         // 2:Cr plane, CbCr pairs
+    }
+}
+
+static void ConvertRgbToRgb(const RkPlane& src, const RkPlane& dst)
+{
+    const size_t count = static_cast<size_t>(src.width) * src.height;
+    for (size_t i = 0; i < count; i++) {
+        const uint8_t* in = src.data + i * src.channels;
+        uint8_t* out = dst.data + i * dst.channels;
+        out[0] = in[0];
+        out[1] = in[1];
+        out[2] = in[2]; // 2:B
+        if (dst.channels == RGBA_BPP) {
+            out[3] = 255; // 3, 255:opaque alpha
+        }
+    }
+}
+
+// same size conversion between any two supported formats
+static void ConvertImage(uint8_t* src, int32_t srcFmt, uint8_t* dst, int32_t dstFmt, uint32_t width, uint32_t height)
+{
+    if (srcFmt == dstFmt) {
+        (void)memcpy(dst, src, GetImageSize(width, height, srcFmt));
+        return;
+    }
+    RkPlane srcPlanes[MAX_PLANES] = {};
+    RkPlane dstPlanes[MAX_PLANES] = {};
+    GetPlanes(src, width, height, srcFmt, srcPlanes);
+    GetPlanes(dst, width, height, dstFmt, dstPlanes);
+    if (IsYuv(srcFmt) && IsYuv(dstFmt)) {
+        (void)memcpy(dstPlanes[0].data, srcPlanes[0].data, static_cast<size_t>(width) * height);
+        ConvertChroma(srcPlanes, srcFmt, dstPlanes);
+    } else if (IsYuv(srcFmt)) {
+        ConvertYuvToRgb(srcPlanes, srcFmt, dstPlanes[0]);
+    } else if (IsYuv(dstFmt)) {
+        ConvertRgbToYuv(srcPlanes[0], dstPlanes, dstFmt);
+    } else {
+        ConvertRgbToRgb(srcPlanes[0], dstPlanes[0]);
+    }
+}
+
+bool RkCpuBlitBackend::Supports(int32_t rkFmt)
+{
+    return IsYuv(rkFmt) || rkFmt == RK_FORMAT_RGB_888 || rkFmt == RK_FORMAT_RGBA_8888;
+}
+
+/*
+ * Scale in the source format, convert, then rotate in the destination format. Every step that is
+ * not needed is skipped and the last step writes straight into the destination.
+ */
+RetCode RkCpuBlitBackend::Blit(const RkBlitImage& src, const RkBlitImage& dst, int32_t rotation)
+{
+    // the scaled image is still in the source format and the converted one in the destination format
+    const uint32_t minSize = std::max(MinSize(src.rkFmt), MinSize(dst.rkFmt));
+    if (!Supports(src.rkFmt) || !Supports(dst.rkFmt) || src.virAddr == nullptr || dst.virAddr == nullptr ||
+        std::min({src.width, src.height, dst.width, dst.height}) < minSize) {
+        CAMERA_LOGE("RkCpuBlitBackend::Blit not supported, format %{public}d -> %{public}d",
+            src.rkFmt, dst.rkFmt);
+        return RC_ERROR;
+    }
+
+    const bool swap = rotation == HAL_TRANSFORM_ROT_90 || rotation == HAL_TRANSFORM_ROT_270;
+    const uint32_t width = swap ? dst.height : dst.width;
+    const uint32_t height = swap ? dst.width : dst.height;
+    uint8_t* cur = static_cast<uint8_t*>(src.virAddr);
+    uint8_t* out = static_cast<uint8_t*>(dst.virAddr);
+
+    if (src.width != width || src.height != height) {
+        bool last = rotation == 0 && src.rkFmt == dst.rkFmt;
+        if (!last) {
+            RkBufferPool::GetInstance().Reserve(scaled_, GetImageSize(width, height, src.rkFmt));
+        }
+        uint8_t* target = last ? out : scaled_.GetData();
+        if (target == nullptr) {
+            return RC_ERROR;
+        }
+        RkPlane srcPlanes[MAX_PLANES] = {};
+        RkPlane dstPlanes[MAX_PLANES] = {};
+        uint32_t count = GetPlanes(cur, src.width, src.height, src.rkFmt, srcPlanes);
+        GetPlanes(target, width, height, src.rkFmt, dstPlanes);
+        for (uint32_t i = 0; i < count; i++) {
+            if (ScalePlane(srcPlanes[i], dstPlanes[i], scaleTables_) != RC_OK) {
+                return RC_ERROR;
+            }
+        }
+        cur = target;
+    }
+
+    if (cur != out && (src.rkFmt != dst.rkFmt || rotation == 0)) {
+        if (rotation != 0) {
+            RkBufferPool::GetInstance().Reserve(converted_, GetImageSize(width, height, dst.rkFmt));
+        }
+        uint8_t* target = rotation == 0 ? out : converted_.GetData();
+        if (target == nullptr) {
+            return RC_ERROR;
+        }
+        ConvertImage(cur, src.rkFmt, target, dst.rkFmt, width, height);
+        cur = target;
+    }
+
+    if (rotation != 0) {
+        RkPlane srcPlanes[MAX_PLANES] = {};
+        RkPlane dstPlanes[MAX_PLANES] = {};
+        uint32_t count = GetPlanes(cur, width, height, dst.rkFmt, srcPlanes);
+        GetPlanes(out, dst.width, dst.height, dst.rkFmt, dstPlanes);
+        for (uint32_t i = 0; i < count; i++) {
+            RotatePlane(srcPlanes[i], dstPlanes[i], rotation);
+        }
+    }
+    return RC_OK;
+}
+} // namespace OHOS::Camera
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2024 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HOS_CAMERA_RK_CPU_BLIT_H
+#define HOS_CAMERA_RK_CPU_BLIT_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "rk_blit_backend.h"
+#include "rk_buffer_pool.h"
+
+namespace OHOS::Camera {
+// A few threads shared by every CPU blit, rows are handed out in bands.
+class RkBlitWorkers {
+public:
+    // refers to the caller's callable without copying it, so handing out bands never allocates;
+    // implicit so call sites pass their lambda as it is
+    class BandFunc {
+    public:
+        template <typename Func>
+        BandFunc(const Func& func)
+            : func_(&func), call_([](const void* f, uint32_t begin, uint32_t end) {
+                (*static_cast<const Func*>(f))(begin, end);
+            })
+        {
+        }
+        void operator()(uint32_t begin, uint32_t end) const
+        {
+            call_(func_, begin, end);
+        }
+
+    private:
+        const void* func_;
+        void (*call_)(const void* func, uint32_t begin, uint32_t end);
+    };
+
+    static RkBlitWorkers& GetInstance();
+    // runs func over [0, count) split into bands, the calling thread takes part.
+    // When another caller already owns the workers the whole range runs on the calling thread.
+    void ParallelFor(uint32_t count, uint32_t minBand, const BandFunc& func);
+
+private:
+    RkBlitWorkers();
+    ~RkBlitWorkers();
+    void WorkerLoop();
+    bool RunBand();
+
+    std::vector<std::thread> threads_;
+    std::mutex ownerLock_;
+    std::mutex lock_;
+    std::condition_variable cv_;
+    std::condition_variable doneCv_;
+    const BandFunc* func_ = nullptr;
+    uint32_t count_ = 0;
+    uint32_t band_ = 0;
+    std::atomic<uint32_t> next_ = 0;
+    uint32_t active_ = 0;
+    uint64_t generation_ = 0;
+    bool exit_ = false;
+};
+
+/*
+ * Software implementation of the RGA operations the camera nodes use: NV12, I420, RGB888 and
+ * RGBA8888 conversion, bilinear scaling and rotation by multiples of 90 degrees. The hot loops use
+ * compiler vector extensions, which become NEON on ARM and SSE on x86. Blits are synchronous.
+ */
+class RkCpuBlitBackend : public RkBlitBackend {
+public:
+    static bool Supports(int32_t rkFmt);
+
+    const char* GetName() const override
+    {
+        return "cpu";
+    }
+    RetCode Blit(const RkBlitImage& src, const RkBlitImage& dst, int32_t rotation) override;
+    void Flush() override {}
+
+private:
+    RkPoolBuffer scaled_;
+    RkPoolBuffer converted_;
+    RkPoolBuffer scaleTables_;  // column indices and weights of the plane being scaled
+};
+} // namespace OHOS::Camera
+#endif
@@ -0,0 +1,227 @@
+/*
+ * Copyright (c) 2024 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "rk_dump_writer.h"
+#include <algorithm>
+#include <cstdlib>
+#include <ctime>
+#include <fcntl.h>
+#include <unistd.h>
+#include <securec.h>
+#include "camera.h"
+#include "camera_dump.h"
+#include "parameter.h"
+
+namespace OHOS::Camera {
+static constexpr const char* DUMP_DIR = "/data/local/tmp";
+static constexpr const char* DUMP_INTERVAL_PARAM = "persist.vendor.camera.rk.dump.interval";
+static constexpr const char* DUMP_KEYFRAME_PARAM = "persist.vendor.camera.rk.dump.keyframe";
+static constexpr uint32_t DUMP_PARAM_LEN = 16;
+static constexpr uint64_t DUMP_CONFIG_PERIOD_NS = 1000000000ULL;    // 1000000000:parameters re-read once a second
+static constexpr size_t DUMP_RING_DEPTH = 8;                        // 8:frames waiting for the writer
+static constexpr size_t DUMP_RING_BYTES = 64 * 1024 * 1024;         // 64:MB waiting for the writer
+static constexpr size_t DUMP_BUDGET_BYTES = 512 * 1024 * 1024;      // 512:MB written per configuration
+
+static uint64_t NowNs()
+{
+    struct timespec ts = {};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec; // 1000000000:ns per second
+}
+
+static uint32_t ReadParameter(const char* key)
+{
+    char value[DUMP_PARAM_LEN] = {0};
+    if (GetParameter(key, "0", value, sizeof(value)) <= 0) {
+        return 0;
+    }
+    return static_cast<uint32_t>(strtoul(value, nullptr, 10)); // 10:decimal
+}
+
+static const char* GetDumpExtension(int32_t encodeType)
+{
+    if (encodeType == ENCODE_TYPE_JPEG) {
+        return "jpeg";
+    }
+    if (encodeType == ENCODE_TYPE_H264) {
+        return "h264";
+    }
+    if (encodeType == ENCODE_TYPE_H265) {
+        return "h265";
+    }
+    return "yuv";
+}
+
+RkDumpWriter& RkDumpWriter::GetInstance()
+{
+    // never destroyed, the writer thread runs for the life of the process
+    static RkDumpWriter* instance = new RkDumpWriter();
+    return *instance;
+}
+
+bool RkDumpWriter::RefreshConfig()
+{
+    std::lock_guard<std::mutex> l(configLock_);
+    uint64_t now = NowNs();
+    if (configCheckedNs_ != 0 && now - configCheckedNs_ < DUMP_CONFIG_PERIOD_NS) {
+        return interval_ != 0;
+    }
+    configCheckedNs_ = now;
+    uint32_t interval = ReadParameter(DUMP_INTERVAL_PARAM);
+    bool keyFrameOnly = ReadParameter(DUMP_KEYFRAME_PARAM) != 0;
+    if (interval != interval_ || keyFrameOnly != keyFrameOnly_) {
+        CAMERA_LOGI("RkDumpWriter: interval %{public}u, key frames only %{public}d", interval, keyFrameOnly);
+        interval_ = interval;
+        keyFrameOnly_ = keyFrameOnly;
+        counters_.clear();
+        std::lock_guard<std::mutex> lock(lock_);
+        writtenBytes_ = 0;
+    }
+    return interval_ != 0;
+}
+
+bool RkDumpWriter::IsSampled(const char* name, const std::shared_ptr<IBuffer>& buffer)
+{
+    if (buffer->GetBufferStatus() != CAMERA_BUFFER_STATUS_OK) {
+        return false;
+    }
+    std::lock_guard<std::mutex> l(configLock_);
+    int32_t encodeType = buffer->GetEncodeType();
+    bool video = encodeType == ENCODE_TYPE_H264 || encodeType == ENCODE_TYPE_H265;
+    if (keyFrameOnly_ && video && buffer->GetEsFrameInfo().isKey == 0) {
+        return false;
+    }
+    uint64_t& count = counters_[{name, buffer->GetStreamId()}];
+    return interval_ != 0 && count++ % interval_ == 0;
+}
+
+void RkDumpWriter::Dump(const char* name, const char* type, const std::shared_ptr<IBuffer>& buffer)
+{
+    if (buffer == nullptr) {
+        return;
+    }
+    if (!RefreshConfig()) {
+        CameraDumper::GetInstance().DumpBuffer(name, type, buffer);
+        return;
+    }
+    if (IsSampled(name, buffer)) {
+        Enqueue(name, buffer);
+    }
+}
+
+void RkDumpWriter::Enqueue(const char* name, const std::shared_ptr<IBuffer>& buffer)
+{
+    bool inSurface = buffer->GetIsValidDataInSurfaceBuffer();
+    const void* src = inSurface ? buffer->GetSuffaceBufferAddr() : buffer->GetVirAddress();
+    size_t size = inSurface ? buffer->GetSuffaceBufferSize() : buffer->GetSize();
+    int32_t esSize = buffer->GetEsFrameInfo().size;
+    if (buffer->GetEncodeType() != ENCODE_TYPE_NULL && esSize > 0) {
+        size = std::min(size, static_cast<size_t>(esSize));
+    }
+    if (src == nullptr || size == 0) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> l(lock_);
+        stats_.sampled++;
+        if (queuedJobs_ >= DUMP_RING_DEPTH || queuedBytes_ + size > DUMP_RING_BYTES) {
+            stats_.droppedFull++;
+            return;
+        }
+        queuedJobs_++;
+        queuedBytes_ += size;
+    }
+
+    Job job;
+    job.size = size;
+    job.data = RkBufferPool::GetInstance().Acquire(size);
+    if (job.data.GetData() != nullptr) {
+        int fd = inSurface ? -1 : buffer->GetFileDescriptor();
+        RkDmaBufBeginCpuAccess(fd);
+        (void)memcpy_s(job.data.GetData(), job.data.GetSize(), src, size);
+        RkDmaBufEndCpuAccess(fd);
+    }
+    uint32_t width = buffer->GetCurWidth() != 0 ? buffer->GetCurWidth() : buffer->GetWidth();
+    uint32_t height = buffer->GetCurHeight() != 0 ? buffer->GetCurHeight() : buffer->GetHeight();
+    job.path = std::string(DUMP_DIR) + "/" + name + "_stream" + std::to_string(buffer->GetStreamId()) +
+        "_frame" + std::to_string(buffer->GetFrameNumber()) + "_" + std::to_string(width) + "x" +
+        std::to_string(height) + "." + GetDumpExtension(buffer->GetEncodeType());
+
+    std::lock_guard<std::mutex> l(lock_);
+    if (job.data.GetData() == nullptr) {
+        stats_.droppedMemory++;
+        queuedJobs_--;
+        queuedBytes_ -= size;
+        return;
+    }
+    jobs_.push_back(std::move(job));
+    if (!writer_.joinable()) {
+        writer_ = std::thread([this] { WriterLoop(); });
+    }
+    cv_.notify_one();
+}
+
+void RkDumpWriter::WriterLoop()
+{
+    std::unique_lock<std::mutex> l(lock_);
+    while (true) {
+        cv_.wait(l, [this] { return !jobs_.empty(); });
+        Job job = std::move(jobs_.front());
+        jobs_.pop_front();
+        bool overBudget = writtenBytes_ + job.size > DUMP_BUDGET_BYTES;
+        l.unlock();
+
+        bool written = false;
+        if (!overBudget) {
+            int fd = open(job.path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644); // 0644:rw-r--r--
+            if (fd >= 0) {
+                written = write(fd, job.data.GetData(), job.size) == static_cast<ssize_t>(job.size);
+                close(fd);
+            }
+            if (!written) {
+                CAMERA_LOGE("RkDumpWriter: write %{public}s failed", job.path.c_str());
+            }
+        }
+        job.data.Release();
+
+        l.lock();
+        if (written) {
+            stats_.written++;
+            writtenBytes_ += job.size;
+        } else {
+            stats_.failed++;
+        }
+        queuedJobs_--;
+        queuedBytes_ -= job.size;
+    }
+}
+
+RkDumpStats RkDumpWriter::GetStats()
+{
+    std::lock_guard<std::mutex> l(lock_);
+    return stats_;
+}
+
+void RkDumpWriter::LogStats(const char* tag)
+{
+    RkDumpStats stats = GetStats();
+    if (stats.sampled == 0) {
+        return;
+    }
+    CAMERA_LOGI("%{public}s dumps: sampled %{public}llu, written %{public}llu, dropped %{public}llu ring full "
+        "%{public}llu no memory, failed %{public}llu", tag, static_cast<unsigned long long>(stats.sampled),
+        static_cast<unsigned long long>(stats.written), static_cast<unsigned long long>(stats.droppedFull),
+        static_cast<unsigned long long>(stats.droppedMemory), static_cast<unsigned long long>(stats.failed));
+}
+} // namespace OHOS::Camera
@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2024 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HOS_CAMERA_RK_DUMP_WRITER_H
+#define HOS_CAMERA_RK_DUMP_WRITER_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "ibuffer.h"
+#include "rk_buffer_pool.h"
+
+namespace OHOS::Camera {
+struct RkDumpStats {
+    uint64_t sampled = 0;       // frames picked by the sampling rule
+    uint64_t written = 0;
+    uint64_t droppedFull = 0;   // the ring was full, the writer is behind the stream
+    uint64_t droppedMemory = 0; // no memory for the copy
+    uint64_t failed = 0;        // the file could not be written, or the byte budget is spent
+};
+
+/*
+ * Frame dumps that stay off the streaming thread. Enabled with
+ *   param set persist.vendor.camera.rk.dump.interval N    dump every Nth frame of each node and stream, 0 off
+ *   param set persist.vendor.camera.rk.dump.keyframe 1    of encoded streams, count only key frames
+ * The frame is copied into a pooled slab and queued, a background thread writes it to /data/local/tmp.
+ * When the ring is full the dump is dropped and counted, the frame is never held back. At most 512 MB
+ * are written until the parameters change.
+ * With the interval at 0 Dump forwards to the synchronous CameraDumper, which hidumper controls.
+ */
+class RkDumpWriter {
+public:
+    static RkDumpWriter& GetInstance();
+
+    // call from DeliverBuffer in place of CameraDumper::DumpBuffer
+    void Dump(const char* name, const char* type, const std::shared_ptr<IBuffer>& buffer);
+    RkDumpStats GetStats();
+    void LogStats(const char* tag);
+
+private:
+    struct Job {
+        std::string path;
+        RkPoolBuffer data;
+        size_t size;
+    };
+
+    RkDumpWriter() = default;
+    ~RkDumpWriter() = default;
+    bool RefreshConfig();
+    bool IsSampled(const char* name, const std::shared_ptr<IBuffer>& buffer);
+    void Enqueue(const char* name, const std::shared_ptr<IBuffer>& buffer);
+    void WriterLoop();
+
+    std::mutex configLock_;
+    uint64_t configCheckedNs_ = 0;
+    uint32_t interval_ = 0;
+    bool keyFrameOnly_ = false;
+    std::map<std::pair<std::string, int32_t>, uint64_t> counters_;
+
+    std::mutex lock_;
+    std::condition_variable cv_;
+    std::deque<Job> jobs_;
+    size_t queuedJobs_ = 0;     // counted from the moment a slot is reserved, before the copy
+    size_t queuedBytes_ = 0;
+    size_t writtenBytes_ = 0;
+    std::thread writer_;
+    RkDumpStats stats_;
+};
+} // namespace OHOS::Camera
+#endif
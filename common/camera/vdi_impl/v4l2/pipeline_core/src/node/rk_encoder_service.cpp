@@ -0,0 +1,305 @@
+/*
+ * Copyright (c) 2024 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "rk_encoder_service.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include "rk_soc_caps.h"
+#include "rk_trace.h"
+
+namespace OHOS::Camera {
+static constexpr int64_t TIME_CONVERSION_S_NS = 1000000000LL; /* s to ns */
+static constexpr int64_t DEFAULT_PERIOD_NS = 33333333LL;    // 33333333:30 fps until the arrivals tell otherwise
+static constexpr int64_t MIN_PERIOD_NS = 4000000LL;         // 4000000:250 fps
+static constexpr int64_t MAX_PERIOD_NS = 200000000LL;       // 200000000:5 fps
+static constexpr int64_t PERIOD_SMOOTHING = 8;              // 8:weight of the old estimate, 1/8 for a new sample
+static constexpr int64_t DEADLINE_TIE_NS = 1000000LL;       // 1000000:deadlines closer than 1 ms are a tie
+static constexpr uint64_t STATS_REPORT_INTERVAL = 300;      // 300:frames between two reports of a session
+static constexpr int64_t BITRATE_WINDOW_NS = 1000000000LL;  // 1000000000:bitrate measured over one second
+static constexpr uint64_t BITS_PER_BYTE = 8;
+// single context SoCs: a session keeps the context for 100 ms, three frames at 30 fps, which the codec
+// pipeline of the waiting session can hold without dropping
+static constexpr int64_t CONTEXT_SLICE_NS = 100000000LL;   // 100000000:100 ms
+
+static int64_t GetMonotonicTimeNs()
+{
+    struct timespec ts = {};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * TIME_CONVERSION_S_NS + ts.tv_nsec;
+}
+
+RkEncoderService& RkEncoderService::GetInstance()
+{
+    // never destroyed, a node may close its session while the process exits
+    static RkEncoderService* instance = new RkEncoderService();
+    return *instance;
+}
+
+int32_t RkEncoderService::OpenSession(const std::string& name)
+{
+    std::lock_guard<std::mutex> l(lock_);
+    int32_t id = nextSession_++;
+    auto session = std::make_unique<Session>();
+    session->name = name;
+    session->periodNs = DEFAULT_PERIOD_NS;
+    sessions_[id] = std::move(session);
+    if (workers_.empty()) {
+        uint64_t generation = ++generation_;
+        uint32_t workers = RkSocCaps::MPP_MULTI_CTX ? std::max(RkSocCaps::ENCODER_CORES, 1U) : 1;
+        for (uint32_t i = 0; i < workers; i++) {
+            workers_.emplace_back([this, generation] { WorkerLoop(generation); });
+        }
+    }
+    CAMERA_LOGI("RkEncoderService open session %{public}d %{public}s, %{public}zu sessions",
+        id, name.c_str(), sessions_.size());
+    return id;
+}
+
+void RkEncoderService::CloseSession(int32_t session)
+{
+    std::unique_ptr<Session> closed;
+    std::vector<std::thread> workers;
+    std::deque<Pending> stale;
+    {
+        std::unique_lock<std::mutex> l(lock_);
+        auto it = sessions_.find(session);
+        if (it == sessions_.end()) {
+            return;
+        }
+        Session* s = it->second.get();
+        cv_.wait(l, [s] { return !s->busy; });
+        // keeps the workers away from the session while what it still has queued is dropped
+        s->busy = true;
+        stale.swap(s->queue);
+        s->stats.dropped += stale.size();
+        if (contextOwner_ == s) {
+            contextOwner_ = nullptr;
+        }
+        closed = std::move(it->second);
+        sessions_.erase(it);
+        if (sessions_.empty()) {
+            generation_++;
+            workers.swap(workers_);
+            cv_.notify_all();
+        }
+    }
+    for (auto& pending : stale) {
+        pending.request.done(RC_ERROR, 0, true);
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    LogStats(*closed);
+    // the MPP context goes with the session
+}
+
+void RkEncoderService::RequestIdr(int32_t session)
+{
+    std::lock_guard<std::mutex> l(lock_);
+    auto it = sessions_.find(session);
+    if (it != sessions_.end()) {
+        it->second->idrPending = true;
+    }
+}
+
+void RkEncoderService::Submit(int32_t session, RkEncodeRequest&& request)
+{
+    std::unique_lock<std::mutex> l(lock_);
+    auto it = sessions_.find(session);
+    if (it == sessions_.end()) {
+        l.unlock();
+        request.done(RC_ERROR, 0, true);
+        return;
+    }
+    Session& s = *it->second;
+    int64_t now = GetMonotonicTimeNs();
+    if (s.lastArrivalNs != 0) {
+        int64_t interval = std::clamp(now - s.lastArrivalNs, MIN_PERIOD_NS, MAX_PERIOD_NS);
+        s.periodNs = (s.periodNs * (PERIOD_SMOOTHING - 1) + interval) / PERIOD_SMOOTHING;
+    }
+    s.lastArrivalNs = now;
+    // with a single context a frame may wait out the slice of another session, then its session
+    // encodes what it has queued back to back instead of dropping it
+    int64_t slack = RkSocCaps::MPP_MULTI_CTX ? 0 : CONTEXT_SLICE_NS;
+    s.queue.push_back({std::move(request), now + s.periodNs + slack});
+    s.stats.queueDepth = s.queue.size();
+    s.stats.maxQueueDepth = std::max(s.stats.maxQueueDepth, s.stats.queueDepth);
+    RK_TRACE_COUNTER("RkEncoderService queue", s.queue.size());
+    cv_.notify_one();
+}
+
+RkEncodeSessionStats RkEncoderService::GetStats(int32_t session)
+{
+    std::lock_guard<std::mutex> l(lock_);
+    auto it = sessions_.find(session);
+    return it == sessions_.end() ? RkEncodeSessionStats() : it->second->stats;
+}
+
+RkEncoderService::Session* RkEncoderService::PickLocked(int64_t now,
+    std::vector<std::pair<Session*, Pending>>& stale)
+{
+    Session* best = nullptr;
+    for (auto& [id, session] : sessions_) {
+        Session* s = session.get();
+        if (s->busy || s->queue.empty()) {
+            continue;
+        }
+        // a newer frame is waiting, encoding this one late would only delay that one too
+        while (s->queue.size() > 1 && s->queue.front().deadlineNs < now) {
+            stale.emplace_back(s, std::move(s->queue.front()));
+            s->queue.pop_front();
+            s->stats.dropped++;
+        }
+        s->stats.queueDepth = s->queue.size();
+        if (best == nullptr) {
+            best = s;
+            continue;
+        }
+        // earliest deadline first; once both are overdue the encoder is overloaded and the session
+        // that has had less of it goes first, so the drops are shared rather than hitting one camera
+        int64_t deadline = s->queue.front().deadlineNs;
+        int64_t bestDeadline = best->queue.front().deadlineNs;
+        bool overdue = deadline < now && bestDeadline < now;
+        int64_t difference = deadline - bestDeadline;
+        if ((overdue || std::abs(difference) <= DEADLINE_TIE_NS) ? s->encodeNs < best->encodeNs : difference < 0) {
+            best = s;
+        }
+    }
+    if (!RkSocCaps::MPP_MULTI_CTX && contextOwner_ != nullptr && best != contextOwner_ &&
+        now < contextSliceEndNs_) {
+        // the others wait for the slice to end
+        bool ownerReady = !contextOwner_->busy && !contextOwner_->queue.empty();
+        return ownerReady ? contextOwner_ : nullptr;
+    }
+    return best;
+}
+
+void RkEncoderService::WorkerLoop(uint64_t generation)
+{
+    std::unique_lock<std::mutex> l(lock_);
+    while (true) {
+        std::vector<std::pair<Session*, Pending>> stale;
+        Session* s = nullptr;
+        int64_t now = GetMonotonicTimeNs();
+        while (generation == generation_ && (s = PickLocked(now, stale)) == nullptr && stale.empty()) {
+            if (now < contextSliceEndNs_) {
+                cv_.wait_for(l, std::chrono::nanoseconds(contextSliceEndNs_ - now));
+            } else {
+                cv_.wait(l);
+            }
+            now = GetMonotonicTimeNs();
+        }
+        if (generation != generation_) {
+            break;
+        }
+        if (!stale.empty()) {
+            // the sessions stay busy until their dropped frames are completed, so nothing overtakes them
+            for (auto& [owner, pending] : stale) {
+                owner->busy = true;
+            }
+            if (s != nullptr) {
+                s->busy = true;
+            }
+            l.unlock();
+            for (auto& [owner, pending] : stale) {
+                pending.request.done(RC_ERROR, 0, true);
+            }
+            l.lock();
+            for (auto& [owner, pending] : stale) {
+                owner->busy = owner == s;
+            }
+            cv_.notify_all();
+            if (s == nullptr) {
+                continue;
+            }
+        }
+
+        Pending pending = std::move(s->queue.front());
+        s->queue.pop_front();
+        s->stats.queueDepth = s->queue.size();
+        s->busy = true;
+        bool idr = s->idrPending;
+        s->idrPending = false;
+        if (!RkSocCaps::MPP_MULTI_CTX && contextOwner_ != s) {
+            // one context for the whole process, the session taking it over starts with an IDR
+            if (contextOwner_ != nullptr) {
+                contextOwner_->encoder.Close();
+            }
+            contextOwner_ = s;
+            contextSliceEndNs_ = now + CONTEXT_SLICE_NS;
+        }
+        l.unlock();
+
+        int64_t begin = GetMonotonicTimeNs();
+        RetCode rc = RC_OK;
+        {
+            std::lock_guard<std::mutex> open(openLock_);
+            rc = s->encoder.Open(pending.request.config);
+        }
+        size_t esSize = 0;
+        if (rc == RC_OK) {
+            if (idr) {
+                s->encoder.RequestIdr();
+            }
+            rc = s->encoder.Encode(pending.request.fd, pending.request.output, esSize);
+        }
+        int64_t end = GetMonotonicTimeNs();
+        // completed before the session is released, so the next frame of the session can not overtake it
+        pending.request.done(rc, rc == RC_OK ? esSize : 0, false);
+
+        l.lock();
+        s->busy = false;
+        s->encodeNs += end - begin;
+        if (rc != RC_OK) {
+            s->stats.failed++;
+        } else {
+            s->stats.encoded++;
+            s->stats.late += end > pending.deadlineNs ? 1 : 0;
+            s->stats.lastFrameBytes = static_cast<uint32_t>(esSize);
+            s->stats.targetBitrate = pending.request.config.rc.bitrate;
+            s->windowBytes += esSize;
+            if (s->windowStartNs == 0) {
+                s->windowStartNs = end;
+            } else if (end - s->windowStartNs >= BITRATE_WINDOW_NS) {
+                s->stats.bitrate = static_cast<uint32_t>(s->windowBytes * BITS_PER_BYTE * TIME_CONVERSION_S_NS /
+                    (end - s->windowStartNs));
+                s->windowStartNs = end;
+                s->windowBytes = 0;
+            }
+            if (s->firstEncodeNs == 0) {
+                s->firstEncodeNs = end;
+            } else {
+                s->stats.fps = static_cast<double>(s->stats.encoded - 1) * TIME_CONVERSION_S_NS /
+                    (end - s->firstEncodeNs);
+            }
+            if (s->stats.encoded % STATS_REPORT_INTERVAL == 0) {
+                LogStats(*s);
+            }
+        }
+        cv_.notify_all();
+    }
+}
+
+void RkEncoderService::LogStats(const Session& session) const
+{
+    const RkEncodeSessionStats& stats = session.stats;
+    CAMERA_LOGI("RkEncoderService %{public}s: %{public}.1f fps, encoded %{public}llu, failed %{public}llu, "
+        "dropped %{public}llu, late %{public}llu, queue %{public}u max %{public}u, period %{public}lld us, "
+        "%{public}u bps of %{public}u", session.name.c_str(), stats.fps, static_cast<unsigned long long>(stats.encoded),
+        static_cast<unsigned long long>(stats.failed), static_cast<unsigned long long>(stats.dropped),
+        static_cast<unsigned long long>(stats.late), stats.queueDepth, stats.maxQueueDepth,
+        static_cast<long long>(session.periodNs / 1000), stats.bitrate, stats.targetBitrate); // 1000:ns to us
+}
+} // namespace OHOS::Camera
@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2024 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HOS_CAMERA_RK_ENCODER_SERVICE_H
+#define HOS_CAMERA_RK_ENCODER_SERVICE_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "rk_mpp_encoder.h"
+
+namespace OHOS::Camera {
+struct RkEncodeSessionStats {
+    double fps = 0;
+    uint32_t queueDepth = 0;    // frames waiting for an encoder right now
+    uint32_t maxQueueDepth = 0;
+    uint64_t encoded = 0;
+    uint64_t failed = 0;
+    uint64_t dropped = 0;       // missed their deadline while a newer frame of the session was waiting
+    uint64_t late = 0;          // encoded, but after their deadline
+    // for a streamer adapting RK_VIDEO_BITRATE to its link; QP is not reported by the MPP wrapper
+    uint32_t lastFrameBytes = 0;
+    uint32_t targetBitrate = 0; // bits per second requested, 0: the encoder default
+    uint32_t bitrate = 0;       // bits per second produced over the last second
+};
+
+struct RkEncodeRequest {
+    RkEncoderConfig config;
+    int32_t fd = -1;
+    unsigned char* output = nullptr;
+    // called once on an encoder thread; frames of one session complete in the order they were submitted
+    std::function<void(RetCode rc, size_t esSize, bool dropped)> done;
+};
+
+/*
+ * One H.264/H.265 service shared by every camera and stream of the process. Each session (a recording
+ * stream) keeps its own MPP context and its frames are encoded one at a time in order, while
+ * frames of different sessions are encoded concurrently on up to RkSocCaps::ENCODER_CORES threads.
+ * The next frame is the one with the earliest deadline, which is its arrival plus the frame period
+ * of its session, so every session gets encoder time in proportion to its frame rate. A frame that
+ * misses its deadline while a newer one of the same session waits is dropped instead of encoded late.
+ * When the encoder is overloaded the session that has used it least goes first.
+ * On SoCs whose MPP wrapper has a single context, sessions take turns on that context, each keeping it
+ * for at least a time slice, since every hand over reopens the encoder and starts with an IDR.
+ */
+class RkEncoderService {
+public:
+    static RkEncoderService& GetInstance();
+
+    int32_t OpenSession(const std::string& name);
+    // drops the frames still waiting and returns once the frame being encoded has completed
+    void CloseSession(int32_t session);
+    void RequestIdr(int32_t session);
+    void Submit(int32_t session, RkEncodeRequest&& request);
+    RkEncodeSessionStats GetStats(int32_t session);
+
+private:
+    struct Pending {
+        RkEncodeRequest request;
+        int64_t deadlineNs;
+    };
+    struct Session {
+        std::string name;
+        RkMppEncoder encoder;
+        std::deque<Pending> queue;
+        bool busy = false;
+        bool idrPending = false;
+        int64_t lastArrivalNs = 0;
+        int64_t periodNs = 0;
+        int64_t firstEncodeNs = 0;
+        uint64_t encodeNs = 0;      // encoder time used, breaks deadline ties
+        int64_t windowStartNs = 0;
+        uint64_t windowBytes = 0;
+        RkEncodeSessionStats stats;
+    };
+
+    RkEncoderService() = default;
+    ~RkEncoderService() = default;
+    Session* PickLocked(int64_t now, std::vector<std::pair<Session*, Pending>>& stale);
+    void WorkerLoop(uint64_t generation);
+    void LogStats(const Session& session) const;
+
+    std::mutex lock_;
+    std::condition_variable cv_;
+    std::map<int32_t, std::unique_ptr<Session>> sessions_;
+    int32_t nextSession_ = 0;
+    std::vector<std::thread> workers_;
+    // workers run while generation_ is the one they were started with, so workers a close is still
+    // joining never pick up the sessions an open started new ones for
+    uint64_t generation_ = 0;
+    Session* contextOwner_ = nullptr;   // single context SoCs: the session whose encoder is open
+    int64_t contextSliceEndNs_ = 0;     // until then no other session takes the context over
+    std::mutex openLock_;               // contexts are created one at a time from the wrapper's defaults
+};
+} // namespace OHOS::Camera
+#endif
@@ -0,0 +1,316 @@
+/*
+ * Copyright (c) 2024 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "rk_exif_template.h"
+#include <cmath>
+#include <cstring>
+#include <securec.h>
+
+namespace OHOS::Camera {
+static constexpr uint8_t JPEG_MARKER = 0xFF;
+static constexpr uint8_t JPEG_SOI = 0xD8;
+static constexpr uint8_t JPEG_APP0 = 0xE0;
+static constexpr uint8_t JPEG_APP1 = 0xE1;
+static constexpr uint8_t JPEG_COM = 0xFE;
+static constexpr size_t JPEG_MARKER_SIZE = 2;
+static constexpr size_t JPEG_SEGMENT_HEADER = 4;    // 4:marker and length
+static constexpr uint8_t EXIF_ID[] = {'E', 'x', 'i', 'f', 0x00, 0x00};
+static constexpr size_t TIFF_START = JPEG_SEGMENT_HEADER + sizeof(EXIF_ID);
+static constexpr size_t TIFF_HEADER_SIZE = 8;       // 8:byte order, 42 and the IFD0 offset
+static constexpr size_t IFD_ENTRY_SIZE = 12;        // 12:tag, type, count and value
+static constexpr size_t DATE_TIME_SIZE = 20;        // 20:"YYYY:MM:DD HH:MM:SS" and its NUL
+static constexpr uint32_t RATIONAL_SIZE = 8;
+static constexpr uint32_t GPS_DMS_COUNT = 3;        // 3:degrees, minutes, seconds
+static constexpr uint32_t GPS_SECONDS_SCALE = 1000;
+static constexpr uint32_t GPS_ALTITUDE_SCALE = 100;
+static constexpr uint32_t MINUTES_PER_DEGREE = 60;
+
+enum ExifType : uint16_t {
+    EXIF_BYTE = 1,
+    EXIF_ASCII = 2,
+    EXIF_SHORT = 3,
+    EXIF_LONG = 4,
+    EXIF_RATIONAL = 5,
+};
+
+enum ExifTag : uint16_t {
+    TAG_GPS_VERSION = 0x0000,
+    TAG_GPS_LATITUDE_REF = 0x0001,
+    TAG_GPS_LATITUDE = 0x0002,
+    TAG_GPS_LONGITUDE_REF = 0x0003,
+    TAG_GPS_LONGITUDE = 0x0004,
+    TAG_GPS_ALTITUDE_REF = 0x0005,
+    TAG_GPS_ALTITUDE = 0x0006,
+    TAG_ORIENTATION = 0x0112,
+    TAG_DATE_TIME = 0x0132,
+    TAG_EXIF_IFD = 0x8769,
+    TAG_GPS_IFD = 0x8825,
+    TAG_DATE_TIME_ORIGINAL = 0x9003,
+};
+
+static void Put16(uint8_t* p, uint16_t value)
+{
+    p[0] = static_cast<uint8_t>(value >> 8); // 8:high byte
+    p[1] = static_cast<uint8_t>(value);
+}
+
+static void Put32(uint8_t* p, uint32_t value)
+{
+    Put16(p, static_cast<uint16_t>(value >> 16)); // 16:high half
+    Put16(p + 2, static_cast<uint16_t>(value));   // 2:low half
+}
+
+static uint16_t Get16(const uint8_t* p, bool bigEndian)
+{
+    uint8_t high = bigEndian ? p[0] : p[1];
+    uint8_t low = bigEndian ? p[1] : p[0];
+    return static_cast<uint16_t>((high << 8) | low); // 8:high byte
+}
+
+static uint32_t Get32(const uint8_t* p, bool bigEndian)
+{
+    uint32_t first = Get16(p, bigEndian);
+    uint32_t second = Get16(p + 2, bigEndian); // 2:second half
+    return bigEndian ? (first << 16) | second : (second << 16) | first; // 16:half
+}
+
+namespace {
+// Appends big endian IFDs to the segment, values that do not fit an entry go behind the IFD.
+class IfdWriter {
+public:
+    IfdWriter(std::vector<uint8_t>& out, uint16_t count) : out_(out)
+    {
+        start_ = out_.size();
+        out_.resize(start_ + 2 + count * IFD_ENTRY_SIZE + 4, 0); // 2:count, 4:next IFD offset
+        Put16(&out_[start_], count);
+    }
+
+    // returns the segment offset of the 4 value bytes
+    size_t Inline(uint16_t tag, ExifType type, uint32_t count, uint32_t value = 0)
+    {
+        uint8_t* entry = Entry(tag, type, count);
+        Put32(entry + 8, value); // 8:value field
+        return entry + 8 - out_.data(); // 8:value field
+    }
+
+    // reserves size bytes behind the IFD and returns their segment offset
+    size_t External(uint16_t tag, ExifType type, uint32_t count, size_t size)
+    {
+        size_t offset = out_.size();
+        out_.resize(offset + size, 0);
+        uint8_t* entry = Entry(tag, type, count);
+        Put32(entry + 8, static_cast<uint32_t>(offset - TIFF_START)); // 8:value field
+        return offset;
+    }
+
+    size_t GetTiffOffset() const
+    {
+        return start_ - TIFF_START;
+    }
+
+private:
+    uint8_t* Entry(uint16_t tag, ExifType type, uint32_t count)
+    {
+        uint8_t* entry = &out_[start_ + 2 + index_++ * IFD_ENTRY_SIZE]; // 2:count
+        Put16(entry, tag);
+        Put16(entry + 2, type);  // 2:type field
+        Put32(entry + 4, count); // 4:count field
+        return entry;
+    }
+
+    std::vector<uint8_t>& out_;
+    size_t start_ = 0;
+    uint32_t index_ = 0;
+};
+}
+
+RkExifTemplate::RkExifTemplate(bool withGps)
+{
+    app1_.assign({JPEG_MARKER, JPEG_APP1, 0, 0});
+    app1_.insert(app1_.end(), std::begin(EXIF_ID), std::end(EXIF_ID));
+    const uint8_t tiffHeader[TIFF_HEADER_SIZE] = {'M', 'M', 0x00, 0x2A, 0x00, 0x00, 0x00, TIFF_HEADER_SIZE};
+    app1_.insert(app1_.end(), std::begin(tiffHeader), std::end(tiffHeader));
+
+    // entries of an IFD are sorted by tag
+    const uint16_t ifd0Count = withGps ? 4 : 3; // 4:Orientation, DateTime, Exif IFD and GPS IFD
+    IfdWriter ifd0(app1_, ifd0Count);
+    orientationOffset_ = ifd0.Inline(TAG_ORIENTATION, EXIF_SHORT, 1);
+    dateTimeOffset_ = ifd0.External(TAG_DATE_TIME, EXIF_ASCII, DATE_TIME_SIZE, DATE_TIME_SIZE);
+    size_t exifPointer = ifd0.Inline(TAG_EXIF_IFD, EXIF_LONG, 1);
+    size_t gpsPointer = withGps ? ifd0.Inline(TAG_GPS_IFD, EXIF_LONG, 1) : 0;
+
+    IfdWriter exifIfd(app1_, 1);
+    Put32(&app1_[exifPointer], exifIfd.GetTiffOffset());
+    dateTimeOriginalOffset_ = exifIfd.External(TAG_DATE_TIME_ORIGINAL, EXIF_ASCII, DATE_TIME_SIZE,
+        DATE_TIME_SIZE);
+
+    if (withGps) {
+        IfdWriter gpsIfd(app1_, 7); // 7:version, latitude, longitude and altitude with their refs
+        Put32(&app1_[gpsPointer], gpsIfd.GetTiffOffset());
+        gpsOffset_ = gpsPointer;
+        gpsIfd.Inline(TAG_GPS_VERSION, EXIF_BYTE, 4, 0x02020000); // 4:bytes, 0x02020000:version 2.2.0.0
+        latitudeRefOffset_ = gpsIfd.Inline(TAG_GPS_LATITUDE_REF, EXIF_ASCII, 2); // 2:letter and NUL
+        latitudeOffset_ = gpsIfd.External(TAG_GPS_LATITUDE, EXIF_RATIONAL, GPS_DMS_COUNT,
+            GPS_DMS_COUNT * RATIONAL_SIZE);
+        longitudeRefOffset_ = gpsIfd.Inline(TAG_GPS_LONGITUDE_REF, EXIF_ASCII, 2); // 2:letter and NUL
+        longitudeOffset_ = gpsIfd.External(TAG_GPS_LONGITUDE, EXIF_RATIONAL, GPS_DMS_COUNT,
+            GPS_DMS_COUNT * RATIONAL_SIZE);
+        altitudeRefOffset_ = gpsIfd.Inline(TAG_GPS_ALTITUDE_REF, EXIF_BYTE, 1);
+        altitudeOffset_ = gpsIfd.External(TAG_GPS_ALTITUDE, EXIF_RATIONAL, 1, RATIONAL_SIZE);
+        SetGps({0, 0, 0});
+    }
+    Put16(&app1_[JPEG_MARKER_SIZE], static_cast<uint16_t>(app1_.size() - JPEG_MARKER_SIZE));
+    SetOrientation(1);
+    SetDateTime(0);
+}
+
+void RkExifTemplate::SetOrientation(uint16_t orientation)
+{
+    Put16(&app1_[orientationOffset_], orientation);
+}
+
+void RkExifTemplate::SetDateTime(time_t time)
+{
+    if (time == dateTime_) {
+        return;
+    }
+    dateTime_ = time;
+    struct tm local = {};
+    localtime_r(&time, &local);
+    char text[DATE_TIME_SIZE + 1] = {0};
+    (void)strftime(text, sizeof(text), "%Y:%m:%d %H:%M:%S", &local);
+    (void)memcpy_s(&app1_[dateTimeOffset_], DATE_TIME_SIZE, text, DATE_TIME_SIZE);
+    (void)memcpy_s(&app1_[dateTimeOriginalOffset_], DATE_TIME_SIZE, text, DATE_TIME_SIZE);
+}
+
+static void PutDegrees(uint8_t* p, double value)
+{
+    value = std::fabs(value);
+    uint32_t degrees = static_cast<uint32_t>(value);
+    double minutesValue = (value - degrees) * MINUTES_PER_DEGREE;
+    uint32_t minutes = static_cast<uint32_t>(minutesValue);
+    uint32_t seconds = static_cast<uint32_t>(std::lround((minutesValue - minutes) * MINUTES_PER_DEGREE *
+        GPS_SECONDS_SCALE));
+    const uint32_t rationals[] = {degrees, 1, minutes, 1, seconds, GPS_SECONDS_SCALE};
+    for (uint32_t value32 : rationals) {
+        Put32(p, value32);
+        p += sizeof(uint32_t);
+    }
+}
+
+void RkExifTemplate::SetGps(const RkExifGps& gps)
+{
+    if (!HasGps()) {
+        return;
+    }
+    app1_[latitudeRefOffset_] = gps.latitude < 0 ? 'S' : 'N';
+    PutDegrees(&app1_[latitudeOffset_], gps.latitude);
+    app1_[longitudeRefOffset_] = gps.longitude < 0 ? 'W' : 'E';
+    PutDegrees(&app1_[longitudeOffset_], gps.longitude);
+    app1_[altitudeRefOffset_] = gps.altitude < 0 ? 1 : 0;
+    Put32(&app1_[altitudeOffset_], static_cast<uint32_t>(std::lround(std::fabs(gps.altitude) * GPS_ALTITUDE_SCALE)));
+    Put32(&app1_[altitudeOffset_ + sizeof(uint32_t)], GPS_ALTITUDE_SCALE);
+}
+
+static bool IsExifSegment(const uint8_t* segment, size_t length)
+{
+    return segment[1] == JPEG_APP1 && length >= JPEG_MARKER_SIZE + sizeof(EXIF_ID) &&
+        memcmp(segment + JPEG_SEGMENT_HEADER, EXIF_ID, sizeof(EXIF_ID)) == 0;
+}
+
+// Walks the APP0 and EXIF APP1 segments following SOI, returns the offset of the first other marker.
+static size_t SkipLeadingSegments(const uint8_t* jpeg, size_t size, const uint8_t** exif, size_t* exifSize)
+{
+    size_t pos = JPEG_MARKER_SIZE;
+    while (pos + JPEG_SEGMENT_HEADER <= size && jpeg[pos] == JPEG_MARKER) {
+        size_t length = Get16(jpeg + pos + JPEG_MARKER_SIZE, true);
+        if (length < JPEG_MARKER_SIZE || pos + JPEG_MARKER_SIZE + length > size) {
+            break;
+        }
+        bool isExif = IsExifSegment(jpeg + pos, length);
+        if (jpeg[pos + 1] != JPEG_APP0 && !isExif) {
+            break;
+        }
+        if (isExif && exif != nullptr) {
+            *exif = jpeg + pos + TIFF_START;
+            *exifSize = length + JPEG_MARKER_SIZE - TIFF_START;
+        }
+        pos += JPEG_MARKER_SIZE + length;
+    }
+    return pos;
+}
+
+size_t RkExifTemplate::Splice(uint8_t* jpeg, size_t size, size_t capacity) const
+{
+    if (jpeg == nullptr || size < JPEG_SEGMENT_HEADER || jpeg[0] != JPEG_MARKER || jpeg[1] != JPEG_SOI) {
+        return 0;
+    }
+    size_t rest = SkipLeadingSegments(jpeg, size, nullptr, nullptr);
+    size_t room = rest - JPEG_MARKER_SIZE;
+    if (room == app1_.size() || room >= app1_.size() + JPEG_SEGMENT_HEADER) {
+        uint8_t* pad = jpeg + JPEG_MARKER_SIZE + app1_.size();
+        size_t padSize = room - app1_.size();
+        (void)memcpy_s(jpeg + JPEG_MARKER_SIZE, room, app1_.data(), app1_.size());
+        if (padSize != 0) {
+            (void)memset_s(pad, padSize, 0, padSize);
+            pad[0] = JPEG_MARKER;
+            pad[1] = JPEG_COM;
+            Put16(pad + JPEG_MARKER_SIZE, static_cast<uint16_t>(padSize - JPEG_MARKER_SIZE));
+        }
+        return size;
+    }
+    size_t newSize = JPEG_MARKER_SIZE + app1_.size() + size - rest;
+    if (newSize > capacity) {
+        return 0;
+    }
+    (void)memmove_s(jpeg + JPEG_MARKER_SIZE + app1_.size(), capacity - JPEG_MARKER_SIZE - app1_.size(),
+        jpeg + rest, size - rest);
+    (void)memcpy_s(jpeg + JPEG_MARKER_SIZE, capacity - JPEG_MARKER_SIZE, app1_.data(), app1_.size());
+    return newSize;
+}
+
+size_t RkExifTemplate::GetMaxSize()
+{
+    static const size_t maxSize = RkExifTemplate(true).app1_.size();
+    return maxSize;
+}
+
+uint16_t RkExifTemplate::ReadOrientation(const uint8_t* jpeg, size_t size)
+{
+    if (jpeg == nullptr || size < JPEG_SEGMENT_HEADER || jpeg[0] != JPEG_MARKER || jpeg[1] != JPEG_SOI) {
+        return 0;
+    }
+    const uint8_t* tiff = nullptr;
+    size_t tiffSize = 0;
+    SkipLeadingSegments(jpeg, size, &tiff, &tiffSize);
+    if (tiff == nullptr || tiffSize < TIFF_HEADER_SIZE) {
+        return 0;
+    }
+    bool bigEndian = tiff[0] == 'M';
+    size_t ifd0 = Get32(tiff + 4, bigEndian); // 4:IFD0 offset field
+    if (ifd0 + 2 > tiffSize) {                // 2:entry count
+        return 0;
+    }
+    uint16_t count = Get16(tiff + ifd0, bigEndian);
+    for (uint16_t i = 0; i < count; i++) {
+        size_t entry = ifd0 + 2 + i * IFD_ENTRY_SIZE; // 2:entry count
+        if (entry + IFD_ENTRY_SIZE > tiffSize) {
+            break;
+        }
+        if (Get16(tiff + entry, bigEndian) == TAG_ORIENTATION) {
+            return Get16(tiff + entry + 8, bigEndian); // 8:value field
+        }
+    }
+    return 0;
+}
+} // namespace OHOS::Camera
@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2024 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HOS_CAMERA_RK_EXIF_TEMPLATE_H
+#define HOS_CAMERA_RK_EXIF_TEMPLATE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <vector>
+
+namespace OHOS::Camera {
+struct RkExifGps {
+    double latitude;    // degrees, negative south
+    double longitude;   // degrees, negative west
+    double altitude;    // meters, negative below sea level
+};
+
+/*
+ * A serialized EXIF APP1 segment built once per stream: IFD0 with Orientation and DateTime, the
+ * Exif IFD with DateTimeOriginal and, when built with GPS, the GPS IFD. The layout never changes,
+ * so a capture only overwrites the values at their known offsets and splices the segment in.
+ */
+class RkExifTemplate {
+public:
+    explicit RkExifTemplate(bool withGps);
+
+    bool HasGps() const
+    {
+        return gpsOffset_ != 0;
+    }
+    void SetOrientation(uint16_t orientation);
+    void SetDateTime(time_t time);
+    void SetGps(const RkExifGps& gps);
+
+    // Replaces the JFIF APP0 and EXIF APP1 segments the JPEG starts with by the template. When they
+    // hold at least GetMaxSize() bytes, the template is written in place and a COM segment takes up the
+    // rest, otherwise the rest of the JPEG is moved once. Returns the new size, 0 when it is not a JPEG
+    // or would exceed capacity.
+    size_t Splice(uint8_t* jpeg, size_t size, size_t capacity) const;
+    // size of the largest template, the one with GPS, including its marker
+    static size_t GetMaxSize();
+    // Orientation tag of an EXIF APP1 already in the JPEG, 0 when there is none.
+    static uint16_t ReadOrientation(const uint8_t* jpeg, size_t size);
+
+private:
+    std::vector<uint8_t> app1_;
+    size_t orientationOffset_ = 0;
+    size_t dateTimeOffset_ = 0;
+    size_t dateTimeOriginalOffset_ = 0;
+    size_t gpsOffset_ = 0;
+    size_t latitudeRefOffset_ = 0;
+    size_t latitudeOffset_ = 0;
+    size_t longitudeRefOffset_ = 0;
+    size_t longitudeOffset_ = 0;
+    size_t altitudeRefOffset_ = 0;
+    size_t altitudeOffset_ = 0;
+    time_t dateTime_ = -1;
+};
+} // namespace OHOS::Camera
+#endif
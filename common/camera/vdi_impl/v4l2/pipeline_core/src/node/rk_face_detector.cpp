@@ -0,0 +1,396 @@
+/*
+ * Copyright (c) 2024 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "rk_face_detector.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include "camera.h"
+
+namespace OHOS::Camera {
+static constexpr uint32_t FACE_DEFAULT_INTERVAL = 5;    // 5:analyse every 5th frame
+static constexpr uint32_t FACE_MAX_INTERVAL = 60;       // 60:about two seconds at 30 fps
+static constexpr uint64_t FACE_BUDGET_US = 20000;       // 20000:worker time per analysed frame
+static constexpr uint32_t FACE_GRID_WIDTH = 160;        // 160:columns of the analysis grid
+static constexpr uint32_t FACE_MAX_FACES = 10;
+static constexpr uint32_t FACE_MIN_CELLS = 6;           // 6:smallest face side in grid cells
+static constexpr uint32_t FACE_TRACK_HOLD = 2;          // 2:missed detections before a track is dropped
+static constexpr float FACE_MIN_IOU = 0.3;
+
+// skin tone in BT.601 YCbCr, see Chai and Ngan
+static constexpr uint8_t SKIN_MIN_LUMA = 40;
+static constexpr uint8_t SKIN_MIN_CB = 77;
+static constexpr uint8_t SKIN_MAX_CB = 127;
+static constexpr uint8_t SKIN_MIN_CR = 133;
+static constexpr uint8_t SKIN_MAX_CR = 173;
+
+// percentages of the candidate box
+static constexpr uint32_t FACE_MIN_ASPECT = 80;         // 80:height at least 0.8 of the width
+static constexpr uint32_t FACE_MAX_ASPECT = 140;        // 140:taller boxes include the neck
+static constexpr uint32_t FACE_TRIM_ASPECT = 130;       // 130:height a neck box is trimmed to
+static constexpr uint32_t FACE_MIN_FILL = 45;           // 45:skin cells in the box
+static constexpr uint32_t FACE_EYE_TOP = 20;
+static constexpr uint32_t FACE_EYE_BOTTOM = 45;
+static constexpr uint32_t FACE_CHEEK_TOP = 50;
+static constexpr uint32_t FACE_CHEEK_BOTTOM = 75;
+static constexpr uint32_t FACE_EYE_CONTRAST = 97;       // 97:eye band mean below 0.97 of the cheek band mean
+static constexpr uint32_t PERCENT = 100;
+
+typedef uint8_t RkU8x16 __attribute__((vector_size(16)));
+
+RkFaceDetector::RkFaceDetector() : interval_(FACE_DEFAULT_INTERVAL), effectiveInterval_(FACE_DEFAULT_INTERVAL)
+{
+}
+
+RkFaceDetector::~RkFaceDetector()
+{
+    Stop();
+}
+
+void RkFaceDetector::Start()
+{
+    std::lock_guard<std::mutex> l(lock_);
+    if (running_) {
+        return;
+    }
+    running_ = true;
+    pending_ = false;
+    frameCount_ = 0;
+    effectiveInterval_ = interval_;
+    tracks_.clear();
+    worker_ = std::thread([this] { WorkerLoop(); });
+}
+
+void RkFaceDetector::Stop()
+{
+    {
+        std::lock_guard<std::mutex> l(lock_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+    }
+    cv_.notify_all();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+    std::lock_guard<std::mutex> l(resultLock_);
+    faces_.clear();
+    generation_++;
+    CAMERA_LOGI("RkFaceDetector::Stop, %{public}llu frames skipped while busy",
+        static_cast<unsigned long long>(skipped_));
+}
+
+void RkFaceDetector::SetInterval(uint32_t interval)
+{
+    std::lock_guard<std::mutex> l(lock_);
+    interval_ = interval == 0 ? FACE_DEFAULT_INTERVAL : std::min(interval, FACE_MAX_INTERVAL);
+    effectiveInterval_ = interval_;
+}
+
+void RkFaceDetector::Submit(const uint8_t* data, uint32_t width, uint32_t height, uint32_t format)
+{
+    if (data == nullptr || width < 2 || height < 2 || // 2:one chroma sample
+        (format != CAMERA_FORMAT_YCRCB_420_SP && format != CAMERA_FORMAT_YCRCB_420_P)) {
+        return;
+    }
+    std::unique_lock<std::mutex> l(lock_, std::try_to_lock);
+    if (!l.owns_lock() || !running_ || ++frameCount_ < effectiveInterval_) {
+        return;
+    }
+    frameCount_ = 0;
+    if (pending_) {
+        skipped_++;
+        return;
+    }
+
+    // point sample a grid of about FACE_GRID_WIDTH columns, chroma is taken at the same cells
+    const uint32_t step = std::max(1U, (width + FACE_GRID_WIDTH - 1) / FACE_GRID_WIDTH);
+    const bool semiPlanar = format == CAMERA_FORMAT_YCRCB_420_SP;
+    const uint8_t* chroma = data + static_cast<size_t>(width) * height;
+    const uint8_t* cr = chroma + static_cast<size_t>(width / 2) * (height / 2);
+    const size_t chromaStride = semiPlanar ? width : width / 2;
+    Grid& grid = input_;
+    grid.width = width / step;
+    grid.height = height / step;
+    const size_t count = static_cast<size_t>(grid.width) * grid.height;
+    grid.luma.resize(count);
+    grid.cb.resize(count);
+    grid.cr.resize(count);
+    size_t i = 0;
+    for (uint32_t gy = 0; gy < grid.height; gy++) {
+        const uint32_t row = gy * step;
+        const uint8_t* lumaRow = data + static_cast<size_t>(row) * width;
+        const size_t chromaRow = static_cast<size_t>(row / 2) * chromaStride;
+        for (uint32_t gx = 0; gx < grid.width; gx++, i++) {
+            const uint32_t col = gx * step;
+            grid.luma[i] = lumaRow[col];
+            if (semiPlanar) {
+                grid.cb[i] = chroma[chromaRow + (col / 2) * 2];     // 2:Cb Cr pairs
+                grid.cr[i] = chroma[chromaRow + (col / 2) * 2 + 1]; // 2:Cb Cr pairs
+            } else {
+                grid.cb[i] = chroma[chromaRow + col / 2];
+                grid.cr[i] = cr[chromaRow + col / 2];
+            }
+        }
+    }
+    pending_ = true;
+    l.unlock();
+    cv_.notify_one();
+}
+
+uint64_t RkFaceDetector::GetFaces(std::vector<RkFaceRect>& faces)
+{
+    std::lock_guard<std::mutex> l(resultLock_);
+    faces = faces_;
+    return generation_;
+}
+
+void RkFaceDetector::WorkerLoop()
+{
+    std::vector<RkFaceRect> faces;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> l(lock_);
+            cv_.wait(l, [this] { return !running_ || pending_; });
+            if (!running_) {
+                return;
+            }
+            std::swap(input_, work_);
+            pending_ = false;
+        }
+        auto begin = std::chrono::steady_clock::now();
+        faces.clear();
+        Detect(work_, faces);
+        UpdateTracks(faces);
+        auto cost = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin);
+        AdaptInterval(cost.count());
+    }
+}
+
+static void BuildSkinMask(const uint8_t* luma, const uint8_t* cb, const uint8_t* cr, uint8_t* mask, size_t count)
+{
+    size_t i = 0;
+    for (; i + sizeof(RkU8x16) <= count; i += sizeof(RkU8x16)) {
+        RkU8x16 y;
+        RkU8x16 u;
+        RkU8x16 v;
+        (void)memcpy(&y, luma + i, sizeof(y));
+        (void)memcpy(&u, cb + i, sizeof(u));
+        (void)memcpy(&v, cr + i, sizeof(v));
+        // compares give 0 or all ones per lane
+        RkU8x16 skin = (RkU8x16)((y >= SKIN_MIN_LUMA) & (u >= SKIN_MIN_CB) & (u <= SKIN_MAX_CB) &
+            (v >= SKIN_MIN_CR) & (v <= SKIN_MAX_CR));
+        skin &= 1;
+        (void)memcpy(mask + i, &skin, sizeof(skin));
+    }
+    for (; i < count; i++) {
+        mask[i] = luma[i] >= SKIN_MIN_LUMA && cb[i] >= SKIN_MIN_CB && cb[i] <= SKIN_MAX_CB &&
+            cr[i] >= SKIN_MIN_CR && cr[i] <= SKIN_MAX_CR;
+    }
+}
+
+// (width + 1) x (height + 1) summed area table, row 0 and column 0 are zero
+static void BuildIntegral(const uint8_t* src, uint32_t width, uint32_t height, std::vector<uint32_t>& sum)
+{
+    const uint32_t stride = width + 1;
+    sum.assign(static_cast<size_t>(stride) * (height + 1), 0);
+    for (uint32_t y = 0; y < height; y++) {
+        uint32_t rowSum = 0;
+        const uint8_t* in = src + static_cast<size_t>(y) * width;
+        uint32_t* above = sum.data() + static_cast<size_t>(y) * stride;
+        uint32_t* out = above + stride;
+        for (uint32_t x = 0; x < width; x++) {
+            rowSum += in[x];
+            out[x + 1] = above[x + 1] + rowSum;
+        }
+    }
+}
+
+static uint64_t BoxSum(const std::vector<uint32_t>& sum, uint32_t width, uint32_t x0, uint32_t y0,
+    uint32_t x1, uint32_t y1)
+{
+    const size_t stride = width + 1;
+    return static_cast<uint64_t>(sum[y1 * stride + x1]) + sum[y0 * stride + x0] -
+        sum[y0 * stride + x1] - sum[y1 * stride + x0];
+}
+
+void RkFaceDetector::FindCandidates(const Grid& grid, std::vector<Candidate>& candidates)
+{
+    const uint32_t width = grid.width;
+    const uint32_t height = grid.height;
+    const size_t count = static_cast<size_t>(width) * height;
+    mask_.resize(count);
+    BuildSkinMask(grid.luma.data(), grid.cb.data(), grid.cr.data(), mask_.data(), count);
+
+    // 4-connected skin regions, flood filled with an explicit stack
+    labels_.assign(count, 0);
+    for (size_t seed = 0; seed < count; seed++) {
+        if (mask_[seed] == 0 || labels_[seed] != 0) {
+            continue;
+        }
+        Candidate c = {width, height, 0, 0, 0};
+        labels_[seed] = 1;
+        stack_.clear();
+        stack_.push_back(seed);
+        while (!stack_.empty()) {
+            uint32_t i = stack_.back();
+            stack_.pop_back();
+            uint32_t x = i % width;
+            uint32_t y = i / width;
+            c.x0 = std::min(c.x0, x);
+            c.y0 = std::min(c.y0, y);
+            c.x1 = std::max(c.x1, x + 1);
+            c.y1 = std::max(c.y1, y + 1);
+            c.area++;
+            const uint32_t neighbours[] = {
+                x > 0 ? i - 1 : i, x + 1 < width ? i + 1 : i, y > 0 ? i - width : i, y + 1 < height ? i + width : i,
+            };
+            for (uint32_t n : neighbours) {
+                if (mask_[n] != 0 && labels_[n] == 0) {
+                    labels_[n] = 1;
+                    stack_.push_back(n);
+                }
+            }
+        }
+        if (c.x1 - c.x0 >= FACE_MIN_CELLS && c.y1 - c.y0 >= FACE_MIN_CELLS) {
+            candidates.push_back(c);
+        }
+    }
+}
+
+void RkFaceDetector::Detect(const Grid& grid, std::vector<RkFaceRect>& faces)
+{
+    if (grid.width == 0 || grid.height == 0) {
+        return;
+    }
+    std::vector<Candidate> candidates;
+    FindCandidates(grid, candidates);
+    if (candidates.empty()) {
+        return;
+    }
+    BuildIntegral(grid.luma.data(), grid.width, grid.height, lumaSum_);
+    BuildIntegral(mask_.data(), grid.width, grid.height, maskSum_);
+
+    std::sort(candidates.begin(), candidates.end(),
+        [](const Candidate& a, const Candidate& b) { return a.area > b.area; });
+    for (auto& c : candidates) {
+        uint32_t w = c.x1 - c.x0;
+        uint32_t h = c.y1 - c.y0;
+        if (h * PERCENT < w * FACE_MIN_ASPECT) {
+            continue;
+        }
+        if (h * PERCENT > w * FACE_MAX_ASPECT) {
+            h = w * FACE_TRIM_ASPECT / PERCENT;
+            c.y1 = c.y0 + h;
+        }
+        uint64_t skin = BoxSum(maskSum_, grid.width, c.x0, c.y0, c.x1, c.y1);
+        if (skin * PERCENT < static_cast<uint64_t>(w) * h * FACE_MIN_FILL) {
+            continue;
+        }
+        // eyes and brows make the upper band of a face darker than the cheeks below it
+        uint32_t bx0 = c.x0 + w / 8;    // 8:leave out the face outline
+        uint32_t bx1 = c.x1 - w / 8;    // 8:leave out the face outline
+        uint32_t eyeY0 = c.y0 + h * FACE_EYE_TOP / PERCENT;
+        uint32_t eyeY1 = c.y0 + h * FACE_EYE_BOTTOM / PERCENT;
+        uint32_t cheekY0 = c.y0 + h * FACE_CHEEK_TOP / PERCENT;
+        uint32_t cheekY1 = c.y0 + h * FACE_CHEEK_BOTTOM / PERCENT;
+        uint64_t eyeArea = static_cast<uint64_t>(bx1 - bx0) * (eyeY1 - eyeY0);
+        uint64_t cheekArea = static_cast<uint64_t>(bx1 - bx0) * (cheekY1 - cheekY0);
+        if (eyeArea == 0 || cheekArea == 0) {
+            continue;
+        }
+        uint64_t eyeSum = BoxSum(lumaSum_, grid.width, bx0, eyeY0, bx1, eyeY1);
+        uint64_t cheekSum = BoxSum(lumaSum_, grid.width, bx0, cheekY0, bx1, cheekY1);
+        if (eyeSum * cheekArea * PERCENT >= cheekSum * eyeArea * FACE_EYE_CONTRAST) {
+            continue;
+        }
+
+        RkFaceRect face;
+        face.x = static_cast<float>(c.x0) / grid.width;
+        face.y = static_cast<float>(c.y0) / grid.height;
+        face.width = static_cast<float>(w) / grid.width;
+        face.height = static_cast<float>(h) / grid.height;
+        faces.push_back(face);
+        if (faces.size() == FACE_MAX_FACES) {
+            break;
+        }
+    }
+}
+
+static float GetIou(const RkFaceRect& a, const RkFaceRect& b)
+{
+    float w = std::min(a.x + a.width, b.x + b.width) - std::max(a.x, b.x);
+    float h = std::min(a.y + a.height, b.y + b.height) - std::max(a.y, b.y);
+    if (w <= 0 || h <= 0) {
+        return 0;
+    }
+    float overlap = w * h;
+    return overlap / (a.width * a.height + b.width * b.height - overlap);
+}
+
+void RkFaceDetector::UpdateTracks(const std::vector<RkFaceRect>& faces)
+{
+    std::vector<bool> matched(tracks_.size(), false);
+    std::vector<Track> tracks;
+    for (auto face : faces) {
+        int32_t best = -1;
+        float bestIou = FACE_MIN_IOU;
+        for (size_t i = 0; i < tracks_.size(); i++) {
+            float iou = matched[i] ? 0 : GetIou(face, tracks_[i].rect);
+            if (iou >= bestIou) {
+                best = static_cast<int32_t>(i);
+                bestIou = iou;
+            }
+        }
+        if (best >= 0) {
+            matched[best] = true;
+            face.id = tracks_[best].rect.id;
+        } else {
+            face.id = nextId_;
+            nextId_ = nextId_ == INT32_MAX ? 0 : nextId_ + 1;
+        }
+        tracks.push_back({face, 0});
+    }
+    // a face missed once or twice is kept, one bad frame should not make the box blink
+    for (size_t i = 0; i < tracks_.size(); i++) {
+        if (!matched[i] && tracks_[i].misses < FACE_TRACK_HOLD) {
+            tracks.push_back({tracks_[i].rect, tracks_[i].misses + 1});
+        }
+    }
+    bool changed = !tracks.empty() || !tracks_.empty();
+    tracks_.swap(tracks);
+    if (!changed) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> l(resultLock_);
+    faces_.clear();
+    for (auto& track : tracks_) {
+        faces_.push_back(track.rect);
+    }
+    generation_++;
+}
+
+void RkFaceDetector::AdaptInterval(uint64_t costUs)
+{
+    std::lock_guard<std::mutex> l(lock_);
+    if (costUs > FACE_BUDGET_US && effectiveInterval_ < FACE_MAX_INTERVAL) {
+        effectiveInterval_ = std::min(effectiveInterval_ * 2, FACE_MAX_INTERVAL); // 2:back off quickly
+        CAMERA_LOGW("RkFaceDetector took %{public}llu us, analysing every %{public}u frames",
+            static_cast<unsigned long long>(costUs), effectiveInterval_);
+    } else if (costUs < FACE_BUDGET_US / 2 && effectiveInterval_ > interval_) { // 2:well within the budget
+        effectiveInterval_ = std::max(effectiveInterval_ / 2, interval_);           // 2:recover step by step
+    }
+}
+} // namespace OHOS::Camera
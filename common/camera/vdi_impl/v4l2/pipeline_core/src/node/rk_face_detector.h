@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2024 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HOS_CAMERA_RK_FACE_DETECTOR_H
+#define HOS_CAMERA_RK_FACE_DETECTOR_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace OHOS::Camera {
+// A tracked face, position and size are fractions of the frame.
+struct RkFaceRect {
+    float x = 0;
+    float y = 0;
+    float width = 0;
+    float height = 0;
+    int32_t id = 0;     // stays the same while the face is tracked from one detection to the next
+};
+
+/*
+ * Lightweight face detector for the preview stream. Submit() only samples a small luma and chroma
+ * grid of every Nth frame and hands it to a worker thread; when the worker is still busy the frame
+ * is skipped, so the delivering thread never waits. The worker segments skin tone, checks each
+ * candidate for the darker eye band with an integral image of the luma, and keeps face ids stable
+ * by matching new boxes to the previous ones. When a run goes over its latency budget the cadence
+ * backs off until the runs fit again.
+ */
+class RkFaceDetector {
+public:
+    RkFaceDetector();
+    ~RkFaceDetector();
+    RkFaceDetector(const RkFaceDetector&) = delete;
+    RkFaceDetector& operator=(const RkFaceDetector&) = delete;
+
+    void Start();
+    void Stop();
+    // analyse one frame out of interval, 0 keeps the default
+    void SetInterval(uint32_t interval);
+    // data is a tightly packed 4:2:0 frame, CAMERA_FORMAT_YCRCB_420_SP or CAMERA_FORMAT_YCRCB_420_P
+    void Submit(const uint8_t* data, uint32_t width, uint32_t height, uint32_t format);
+    // copies the latest faces, the returned generation changes whenever they do
+    uint64_t GetFaces(std::vector<RkFaceRect>& faces);
+
+private:
+    struct Grid {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        std::vector<uint8_t> luma;
+        std::vector<uint8_t> cb;
+        std::vector<uint8_t> cr;
+    };
+    struct Candidate {
+        uint32_t x0;
+        uint32_t y0;
+        uint32_t x1;    // exclusive
+        uint32_t y1;    // exclusive
+        uint32_t area;
+    };
+    struct Track {
+        RkFaceRect rect;
+        uint32_t misses;
+    };
+
+    void WorkerLoop();
+    void Detect(const Grid& grid, std::vector<RkFaceRect>& faces);
+    void FindCandidates(const Grid& grid, std::vector<Candidate>& candidates);
+    void UpdateTracks(const std::vector<RkFaceRect>& faces);
+    void AdaptInterval(uint64_t costUs);
+
+    std::mutex lock_;
+    std::condition_variable cv_;
+    std::thread worker_;
+    bool running_ = false;
+    bool pending_ = false;
+    Grid input_;
+    uint32_t interval_ = 0;
+    uint32_t effectiveInterval_ = 0;
+    uint32_t frameCount_ = 0;
+    uint64_t skipped_ = 0;
+
+    // worker only
+    Grid work_;
+    std::vector<uint8_t> mask_;
+    std::vector<uint32_t> lumaSum_;
+    std::vector<uint32_t> maskSum_;
+    std::vector<int32_t> labels_;
+    std::vector<uint32_t> stack_;
+    std::vector<Track> tracks_;
+    int32_t nextId_ = 0;
+
+    std::mutex resultLock_;
+    std::vector<RkFaceRect> faces_;
+    uint64_t generation_ = 0;
+};
+} // namespace OHOS::Camera
+#endif
@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2024 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "rk_format_negotiator.h"
+#include <algorithm>
+#include <limits>
+#include "camera.h"
+
+namespace OHOS::Camera {
+// bytes per pixel in halves, so the 4:2:0 formats stay integral
+static uint64_t GetHalfBytesPerPixel(uint32_t format)
+{
+    switch (format) {
+        case CAMERA_FORMAT_RGBA_8888:
+            return 8; // 8:4 bytes
+        case CAMERA_FORMAT_RGB_888:
+            return 6; // 6:3 bytes
+        default:
+            return 3; // 3:1.5 bytes of the YUV 4:2:0 formats
+    }
+}
+
+static uint64_t GetImageBytes(uint32_t format, uint32_t width, uint32_t height)
+{
+    return GetHalfBytesPerPixel(format) * width * height / 2; // 2:half bytes
+}
+
+static RkSourcePath GetPathCost(const RkStreamDemand& demand, uint32_t format, uint32_t width, uint32_t height)
+{
+    RkSourcePath path = {format, width, height, 0};
+    if (format != demand.format || width != demand.width || height != demand.height) {
+        path.cost += GetImageBytes(format, width, height) + GetImageBytes(demand.format, demand.width, demand.height);
+    }
+    return path;
+}
+
+RkFormatNegotiator& RkFormatNegotiator::GetInstance()
+{
+    static RkFormatNegotiator instance;
+    return instance;
+}
+
+RkSourcePlan RkFormatNegotiator::Negotiate(const std::vector<RkStreamDemand>& demands,
+    const std::vector<uint32_t>& candidates)
+{
+    RkSourcePlan plan;
+    if (demands.empty() || candidates.empty()) {
+        return plan;
+    }
+
+    uint32_t width = 0;
+    uint32_t height = 0;
+    for (const auto& demand : demands) {
+        width = std::max(width, demand.width);
+        height = std::max(height, demand.height);
+    }
+    plan.nv12Cost = GetImageBytes(CAMERA_FORMAT_YCRCB_420_SP, width, height);
+    for (const auto& demand : demands) {
+        plan.nv12Cost += GetPathCost(demand, CAMERA_FORMAT_YCRCB_420_SP, width, height).cost;
+    }
+    plan.cost = std::numeric_limits<uint64_t>::max();
+    for (uint32_t format : candidates) {
+        // the ISP writes the shared frame once, every stream pays for its own RGA pass
+        uint64_t cost = GetImageBytes(format, width, height);
+        std::map<int32_t, RkSourcePath> paths;
+        for (const auto& demand : demands) {
+            RkSourcePath path = GetPathCost(demand, format, width, height);
+            cost += path.cost;
+            paths[demand.streamId] = path;
+        }
+        if (cost < plan.cost) {
+            plan.cost = cost;
+            plan.paths.swap(paths);
+        }
+    }
+    return plan;
+}
+
+void RkFormatNegotiator::SetPlan(const std::string& cameraId, const RkSourcePlan& plan)
+{
+    std::lock_guard<std::mutex> l(lock_);
+    ClearPlanLocked(cameraId);
+    plans_[cameraId] = plan;
+    for (const auto& [streamId, path] : plan.paths) {
+        paths_[streamId] = path;
+        CAMERA_LOGI("RkFormatNegotiator %{public}s streamId[%{public}d]: format %{public}u %{public}u x %{public}u, "
+            "cost %{public}llu", cameraId.c_str(), streamId, path.format, path.width, path.height,
+            static_cast<unsigned long long>(path.cost));
+    }
+    CAMERA_LOGI("RkFormatNegotiator %{public}s: %{public}zu streams, cost %{public}llu bytes per frame set, "
+        "%{public}llu in NV12", cameraId.c_str(), plan.paths.size(), static_cast<unsigned long long>(plan.cost),
+        static_cast<unsigned long long>(plan.nv12Cost));
+}
+
+void RkFormatNegotiator::ClearPlan(const std::string& cameraId)
+{
+    std::lock_guard<std::mutex> l(lock_);
+    ClearPlanLocked(cameraId);
+}
+
+void RkFormatNegotiator::ClearPlanLocked(const std::string& cameraId)
+{
+    auto it = plans_.find(cameraId);
+    if (it == plans_.end()) {
+        return;
+    }
+    for (const auto& [streamId, path] : it->second.paths) {
+        paths_.erase(streamId);
+    }
+    plans_.erase(it);
+}
+
+RkSourcePlan RkFormatNegotiator::GetPlan(const std::string& cameraId)
+{
+    std::lock_guard<std::mutex> l(lock_);
+    auto it = plans_.find(cameraId);
+    return it == plans_.end() ? RkSourcePlan() : it->second;
+}
+
+bool RkFormatNegotiator::GetPath(int32_t streamId, RkSourcePath& path)
+{
+    std::lock_guard<std::mutex> l(lock_);
+    auto it = paths_.find(streamId);
+    if (it == paths_.end()) {
+        return false;
+    }
+    path = it->second;
+    return true;
+}
+} // namespace OHOS::Camera
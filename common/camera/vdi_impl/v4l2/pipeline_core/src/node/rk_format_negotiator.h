@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2024 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HOS_CAMERA_RK_FORMAT_NEGOTIATOR_H
+#define HOS_CAMERA_RK_FORMAT_NEGOTIATOR_H
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace OHOS::Camera {
+// what the nodes after the source turn the frames of a stream into
+struct RkStreamDemand {
+    int32_t streamId = -1;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t format = 0;
+};
+
+// how the source delivers the frames of one stream
+struct RkSourcePath {
+    uint32_t format = 0;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint64_t cost = 0;      // bytes RGA reads and writes to meet the demand
+};
+
+struct RkSourcePlan {
+    std::map<int32_t, RkSourcePath> paths;  // by stream id, all with the format and size of the one ISP path
+    uint64_t cost = 0;
+    uint64_t nv12Cost = 0;      // what NV12 at the size of every stream would have cost
+};
+
+/*
+ * Chooses the format and size the sensor delivers for the active streams of a camera. The source
+ * starts a single ISP path, so all streams share it at the largest size in the candidate format that
+ * costs least over all of them, RGA scales it down for the others.
+ * The chosen plan is kept per camera for inspection and per stream for the nodes reading the frames.
+ */
+class RkFormatNegotiator {
+public:
+    static RkFormatNegotiator& GetInstance();
+
+    // candidates in order of preference, a tie goes to the earlier one
+    static RkSourcePlan Negotiate(const std::vector<RkStreamDemand>& demands,
+        const std::vector<uint32_t>& candidates);
+
+    void SetPlan(const std::string& cameraId, const RkSourcePlan& plan);
+    void ClearPlan(const std::string& cameraId);
+    RkSourcePlan GetPlan(const std::string& cameraId);
+    // false when no source negotiated the stream, the frame is then described by the buffer or the board
+    bool GetPath(int32_t streamId, RkSourcePath& path);
+
+private:
+    void ClearPlanLocked(const std::string& cameraId);
+
+    std::mutex lock_;
+    std::map<std::string, RkSourcePlan> plans_;
+    std::map<int32_t, RkSourcePath> paths_;
+};
+} // namespace OHOS::Camera
+#endif
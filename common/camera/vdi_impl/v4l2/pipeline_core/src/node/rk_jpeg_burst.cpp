@@ -0,0 +1,212 @@
+/*
+ * Copyright (c) 2024 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "rk_jpeg_burst.h"
+#include <algorithm>
+#include <ctime>
+#include "camera.h"
+#include "rk_trace.h"
+
+namespace OHOS::Camera {
+static constexpr int64_t TIME_CONVERSION_S_NS = 1000000000LL; /* s to ns */
+static constexpr int64_t TIME_CONVERSION_US_NS = 1000LL; /* us to ns */
+
+static int64_t GetMonotonicTimeNs()
+{
+    struct timespec ts = {};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * TIME_CONVERSION_S_NS + ts.tv_nsec;
+}
+
+RkJpegCompressor::RkJpegCompressor()
+{
+    info.err = jpeg_std_error(&err);
+    jpeg_create_compress(&info);
+}
+
+RkJpegCompressor::~RkJpegCompressor()
+{
+    jpeg_destroy_compress(&info);
+}
+
+RkJpegBurstPool::RkJpegBurstPool(const std::string& name, uint32_t workers) : name_(name)
+{
+    workers = std::max(workers, 1U);
+    for (uint32_t i = 0; i < workers; i++) {
+        workers_.push_back(std::make_unique<Worker>());
+    }
+    for (uint32_t i = 0; i < workers; i++) {
+        workers_[i]->thread = std::thread([this, i] { WorkerLoop(i); });
+    }
+    CAMERA_LOGI("RkJpegBurstPool %{public}s start, %{public}u workers", name_.c_str(), workers);
+}
+
+RkJpegBurstPool::~RkJpegBurstPool()
+{
+    Drain();
+    {
+        std::lock_guard<std::mutex> l(lock_);
+        running_ = false;
+        cv_.notify_all();
+    }
+    for (auto& worker : workers_) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+}
+
+void RkJpegBurstPool::Submit(EncodeFunc encode, DeliverFunc deliver)
+{
+    Shot shot;
+    shot.submitNs = GetMonotonicTimeNs();
+    shot.encode = std::move(encode);
+    shot.deliver = std::move(deliver);
+    {
+        std::lock_guard<std::mutex> l(deliverLock_);
+        if (burstShots_ == 0 && burstStartNs_ == 0) {
+            burstStartNs_ = shot.submitNs;
+        }
+    }
+
+    std::lock_guard<std::mutex> l(lock_);
+    shot.sequence = submitted_++;
+    Worker& worker = *workers_[shot.sequence % workers_.size()];
+    {
+        std::lock_guard<std::mutex> lock(worker.lock);
+        worker.shots.push_back(std::move(shot));
+    }
+    queued_++;
+    RK_TRACE_COUNTER("RkJpegBurstPool queued", queued_);
+    cv_.notify_one();
+}
+
+void RkJpegBurstPool::Drain()
+{
+    std::unique_lock<std::mutex> l(deliverLock_);
+    drainCv_.wait(l, [this] {
+        std::lock_guard<std::mutex> lock(lock_);
+        return delivered_ == submitted_;
+    });
+}
+
+bool RkJpegBurstPool::TakeShot(uint32_t index, Shot& shot)
+{
+    bool taken = false;
+    {
+        Worker& own = *workers_[index];
+        std::lock_guard<std::mutex> l(own.lock);
+        if (!own.shots.empty()) {
+            shot = std::move(own.shots.front());
+            own.shots.pop_front();
+            taken = true;
+        }
+    }
+    if (!taken) {
+        // steal the newest shot of the longest queue, its owner keeps working on the oldest ones
+        Worker* victim = nullptr;
+        size_t longest = 0;
+        for (uint32_t i = 0; i < workers_.size(); i++) {
+            std::lock_guard<std::mutex> l(workers_[i]->lock);
+            if (i != index && workers_[i]->shots.size() > longest) {
+                longest = workers_[i]->shots.size();
+                victim = workers_[i].get();
+            }
+        }
+        if (victim != nullptr) {
+            std::lock_guard<std::mutex> l(victim->lock);
+            if (!victim->shots.empty()) {
+                shot = std::move(victim->shots.back());
+                victim->shots.pop_back();
+                taken = true;
+            }
+        }
+    }
+    if (taken) {
+        std::lock_guard<std::mutex> l(lock_);
+        queued_--;
+    }
+    return taken;
+}
+
+void RkJpegBurstPool::WorkerLoop(uint32_t index)
+{
+    Worker& worker = *workers_[index];
+    while (true) {
+        Shot shot;
+        if (!TakeShot(index, shot)) {
+            std::unique_lock<std::mutex> l(lock_);
+            cv_.wait(l, [this] { return queued_ > 0 || !running_; });
+            if (queued_ == 0 && !running_) {
+                break;
+            }
+            continue;
+        }
+        shot.encode(worker.compressor);
+        Complete(std::move(shot));
+    }
+}
+
+void RkJpegBurstPool::Complete(Shot&& shot)
+{
+    std::unique_lock<std::mutex> l(deliverLock_);
+    uint64_t sequence = shot.sequence;
+    finished_.emplace(sequence, std::move(shot));
+    if (delivering_) {
+        // the worker delivering now picks this shot up once its turn comes
+        return;
+    }
+    delivering_ = true;
+    for (auto it = finished_.find(delivered_); it != finished_.end(); it = finished_.find(delivered_)) {
+        Shot next = std::move(it->second);
+        finished_.erase(it);
+        l.unlock();
+        next.deliver();
+        int64_t latency = GetMonotonicTimeNs() - next.submitNs;
+        l.lock();
+        delivered_++;
+        burstShots_++;
+        burstLatencyNs_ += latency;
+        burstMaxLatencyNs_ = std::max(burstMaxLatencyNs_, latency);
+    }
+    delivering_ = false;
+
+    bool empty = false;
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        empty = delivered_ == submitted_;
+    }
+    if (empty) {
+        ReportBurst();
+    }
+    drainCv_.notify_all();
+}
+
+void RkJpegBurstPool::ReportBurst()
+{
+    if (burstShots_ == 0) {
+        return;
+    }
+    int64_t elapsed = std::max<int64_t>(GetMonotonicTimeNs() - burstStartNs_, 1);
+    CAMERA_LOGI("RkJpegBurstPool %{public}s burst of %{public}u shots in %{public}lld us: %{public}.1f shots/s, "
+        "shot latency avg %{public}lld us max %{public}lld us", name_.c_str(), burstShots_,
+        static_cast<long long>(elapsed / TIME_CONVERSION_US_NS),
+        static_cast<double>(burstShots_) * TIME_CONVERSION_S_NS / elapsed,
+        static_cast<long long>(burstLatencyNs_ / burstShots_ / TIME_CONVERSION_US_NS),
+        static_cast<long long>(burstMaxLatencyNs_ / TIME_CONVERSION_US_NS));
+    burstStartNs_ = 0;
+    burstShots_ = 0;
+    burstLatencyNs_ = 0;
+    burstMaxLatencyNs_ = 0;
+}
+} // namespace OHOS::Camera
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2024 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HOS_CAMERA_RK_JPEG_BURST_H
+#define HOS_CAMERA_RK_JPEG_BURST_H
+
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "rk_buffer_pool.h"
+extern "C" {
+#include <jpeglib.h>
+}
+
+namespace OHOS::Camera {
+// A libjpeg compressor created once and reused for every image its owner encodes.
+struct RkJpegCompressor {
+    RkJpegCompressor();
+    ~RkJpegCompressor();
+    RkJpegCompressor(const RkJpegCompressor&) = delete;
+    RkJpegCompressor& operator=(const RkJpegCompressor&) = delete;
+
+    jpeg_compress_struct info = {};
+    jpeg_error_mgr err = {};
+    RkPoolBuffer overflow;  // output that does not fit the caller's buffer, keeps its slab between images
+};
+
+/*
+ * Encodes burst captures on several cores. Every worker owns a compressor and a queue; shots are
+ * dealt to the queues in turn and a worker whose queue runs dry takes the newest shot of the fullest
+ * other queue. Finished shots are delivered in submission order, by whichever worker completes the
+ * oldest one, so a slow shot holds back the ones behind it but never blocks a worker from encoding.
+ */
+class RkJpegBurstPool {
+public:
+    using EncodeFunc = std::function<void(RkJpegCompressor&)>;
+    using DeliverFunc = std::function<void()>;
+
+    RkJpegBurstPool(const std::string& name, uint32_t workers);
+    ~RkJpegBurstPool();
+    RkJpegBurstPool(const RkJpegBurstPool&) = delete;
+    RkJpegBurstPool& operator=(const RkJpegBurstPool&) = delete;
+
+    void Submit(EncodeFunc encode, DeliverFunc deliver);
+    // returns once every submitted shot has been delivered
+    void Drain();
+
+private:
+    struct Shot {
+        uint64_t sequence = 0;
+        int64_t submitNs = 0;
+        EncodeFunc encode;
+        DeliverFunc deliver;
+    };
+    struct Worker {
+        std::mutex lock;
+        std::deque<Shot> shots;
+        RkJpegCompressor compressor;
+        std::thread thread;
+    };
+
+    void WorkerLoop(uint32_t index);
+    bool TakeShot(uint32_t index, Shot& shot);
+    void Complete(Shot&& shot);
+    void ReportBurst();
+
+    std::string name_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+
+    std::mutex lock_;
+    std::condition_variable cv_;
+    bool running_ = true;
+    uint32_t queued_ = 0;
+    uint64_t submitted_ = 0;
+
+    std::mutex deliverLock_;
+    std::condition_variable drainCv_;
+    std::map<uint64_t, Shot> finished_;
+    uint64_t delivered_ = 0;
+    bool delivering_ = false;
+    // the burst being measured, from its first submission until the pool runs empty
+    int64_t burstStartNs_ = 0;
+    uint32_t burstShots_ = 0;
+    int64_t burstLatencyNs_ = 0;
+    int64_t burstMaxLatencyNs_ = 0;
+};
+} // namespace OHOS::Camera
+#endif
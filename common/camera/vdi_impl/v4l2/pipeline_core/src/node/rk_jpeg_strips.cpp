@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2024 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "rk_jpeg_strips.h"
+#include <cstring>
+#include <securec.h>
+
+namespace OHOS::Camera {
+static constexpr uint8_t JPEG_MARKER = 0xFF;
+static constexpr uint8_t JPEG_SOI = 0xD8;
+static constexpr uint8_t JPEG_EOI = 0xD9;
+static constexpr uint8_t JPEG_SOS = 0xDA;
+static constexpr uint8_t JPEG_SOF0 = 0xC0;
+static constexpr uint8_t JPEG_RST0 = 0xD0;
+static constexpr uint8_t JPEG_RST7 = 0xD7;
+static constexpr uint8_t JPEG_RST_COUNT = 8;        // 8:RST0..RST7 repeat
+static constexpr size_t JPEG_MARKER_SIZE = 2;
+static constexpr size_t JPEG_SEGMENT_HEADER_SIZE = 4; // 4:marker and segment length
+static constexpr size_t SOF_HEIGHT_OFFSET = 5;      // 5:marker, length and precision precede the height
+
+// offset of the first entropy coded byte after the SOS segment, 0 when the JPEG is malformed
+static size_t FindScanData(const uint8_t* data, size_t size, size_t& sofOffset)
+{
+    if (size < JPEG_MARKER_SIZE || data[0] != JPEG_MARKER || data[1] != JPEG_SOI) {
+        return 0;
+    }
+    size_t pos = JPEG_MARKER_SIZE;
+    while (pos + JPEG_SEGMENT_HEADER_SIZE <= size && data[pos] == JPEG_MARKER) {
+        uint8_t marker = data[pos + 1];
+        size_t length = (static_cast<size_t>(data[pos + 2]) << 8) | data[pos + 3]; // 2, 3:big endian, 8:high byte
+        if (pos + JPEG_MARKER_SIZE + length > size) {
+            return 0;
+        }
+        if (marker == JPEG_SOF0) {
+            sofOffset = pos;
+        }
+        pos += JPEG_MARKER_SIZE + length;
+        if (marker == JPEG_SOS) {
+            return pos;
+        }
+    }
+    return 0;
+}
+
+// every FF in entropy coded data is either stuffed with 00 or starts a restart marker
+static void RenumberRestarts(uint8_t* data, size_t size, uint8_t offset)
+{
+    uint8_t* end = data + size;
+    uint8_t* p = data;
+    while ((p = static_cast<uint8_t*>(memchr(p, JPEG_MARKER, end - p))) != nullptr && p + 1 < end) {
+        if (p[1] >= JPEG_RST0 && p[1] <= JPEG_RST7) {
+            p[1] = JPEG_RST0 + (p[1] - JPEG_RST0 + offset) % JPEG_RST_COUNT;
+        }
+        p += JPEG_MARKER_SIZE;
+    }
+}
+
+size_t RkJpegStripStitcher::Stitch(const std::vector<RkJpegStrip>& strips, uint16_t height, uint8_t* output,
+    size_t capacity)
+{
+    if (strips.empty() || output == nullptr) {
+        return 0;
+    }
+    size_t pos = 0;
+    for (size_t i = 0; i < strips.size(); i++) {
+        const RkJpegStrip& strip = strips[i];
+        size_t sofOffset = 0;
+        size_t scan = FindScanData(strip.data, strip.size, sofOffset);
+        if (scan == 0 || sofOffset == 0 || strip.size < scan + JPEG_MARKER_SIZE ||
+            strip.data[strip.size - 2] != JPEG_MARKER || strip.data[strip.size - 1] != JPEG_EOI) { // 2:EOI size
+            return 0;
+        }
+        size_t scanSize = strip.size - JPEG_MARKER_SIZE - scan;
+        if (i == 0) {
+            // the headers of the first strip describe the whole frame once the height is patched
+            if (scan > capacity || memcpy_s(output, capacity, strip.data, scan) != 0) {
+                return 0;
+            }
+            output[sofOffset + SOF_HEIGHT_OFFSET] = static_cast<uint8_t>(height >> 8); // 8:high byte
+            output[sofOffset + SOF_HEIGHT_OFFSET + 1] = static_cast<uint8_t>(height & 0xFF);
+            pos = scan;
+        } else {
+            // the restart marker the encoder would have written after the last row of the previous strip
+            if (pos + JPEG_MARKER_SIZE > capacity || strip.firstMcuRow == 0) {
+                return 0;
+            }
+            output[pos++] = JPEG_MARKER;
+            output[pos++] = JPEG_RST0 + (strip.firstMcuRow - 1) % JPEG_RST_COUNT;
+        }
+        if (pos + scanSize > capacity || memcpy_s(output + pos, capacity - pos, strip.data + scan, scanSize) != 0) {
+            return 0;
+        }
+        RenumberRestarts(output + pos, scanSize, strip.firstMcuRow % JPEG_RST_COUNT);
+        pos += scanSize;
+    }
+    if (pos + JPEG_MARKER_SIZE > capacity) {
+        return 0;
+    }
+    output[pos++] = JPEG_MARKER;
+    output[pos++] = JPEG_EOI;
+    return pos;
+}
+} // namespace OHOS::Camera
@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2024 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HOS_CAMERA_RK_JPEG_STRIPS_H
+#define HOS_CAMERA_RK_JPEG_STRIPS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace OHOS::Camera {
+struct RkJpegStrip {
+    const uint8_t* data;    // a complete baseline JPEG of the strip
+    size_t size;
+    uint32_t firstMcuRow;   // MCU row of the frame the strip starts at
+};
+
+/*
+ * Joins horizontal strips, each encoded on its own as a baseline JPEG with the same tables and a
+ * restart interval of one MCU row, into the JPEG of the whole frame. The headers of the first strip
+ * are kept with the frame height, the entropy coded data of every strip follows with its restart
+ * markers renumbered and one more restart marker between two strips. No coefficient is re-encoded.
+ */
+class RkJpegStripStitcher {
+public:
+    // returns the size of the frame JPEG, 0 when a strip is malformed or the frame exceeds capacity
+    static size_t Stitch(const std::vector<RkJpegStrip>& strips, uint16_t height, uint8_t* output, size_t capacity);
+};
+} // namespace OHOS::Camera
+#endif
@@ -0,0 +1,208 @@
+/*
+ * Copyright (c) 2024 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "rk_mpp_encoder.h"
+#include <ctime>
+#include "rk_soc_caps.h"
+
+namespace OHOS::Camera {
+static constexpr uint64_t TIME_CONVERSION_NS_US = 1000ULL; /* ns to us */
+static constexpr uint64_t TIME_CONVERSION_US_S = 1000000ULL; /* us to s */
+static constexpr uint64_t LATENCY_REPORT_INTERVAL = 300; // 300:frames between two latency reports
+static constexpr uint32_t BITS_PER_PIXEL_SECOND_DIV = 8;  // 8:default bitrate is width * height * fps / 8
+static constexpr uint32_t DEFAULT_GOP_SECONDS = 2;        // 2:seconds between key frames by default
+static constexpr uint32_t BPS_RANGE_DIV = 16;             // 16:bitrate bounds are set in 1/16 of the target
+static constexpr uint32_t BITS_PER_BYTE = 8;
+
+static uint64_t GetMonotonicTimeUs()
+{
+    struct timespec ts = {};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * TIME_CONVERSION_US_S + ts.tv_nsec / TIME_CONVERSION_NS_US;
+}
+
+RkMppEncoder::~RkMppEncoder()
+{
+    Close();
+}
+
+RetCode RkMppEncoder::Open(const RkEncoderConfig& config)
+{
+    if (halCtx_ != nullptr && config_ == config) {
+        if (config_.rc != config.rc) {
+            // MPP takes the new settings from the next frame on, the context and its references stay
+            if (SetRateControl(config) != RC_OK) {
+                CAMERA_LOGE("RkMppEncoder::Open update rate control failed, the previous settings stay");
+            }
+            config_.rc = config.rc;
+        }
+        return RC_OK;
+    }
+    Close();
+
+    MpiEncTestArgs* args = RkSocCaps::GetEncArgs(args_);
+    if (args == nullptr) {
+        CAMERA_LOGE("RkMppEncoder::Open get encoder args failed");
+        return RC_ERROR;
+    }
+    args->width       = config.width;
+    args->height      = config.height;
+    args->format      = config.format;
+    args->type        = config.type;
+
+    uint64_t begin = GetMonotonicTimeUs();
+    halCtx_ = hal_mpp_ctx_create(args);
+    if (halCtx_ == nullptr) {
+        CAMERA_LOGE("RkMppEncoder::Open hal_mpp_ctx_create failed, %{public}u x %{public}u",
+            config.width, config.height);
+        return RC_ERROR;
+    }
+
+    // SPS/PPS must precede every IDR, otherwise a recording started on a requested IDR can not be decoded
+    MpiEncTestData* data = RkSocCaps::GetEncData(halCtx_);
+    MppEncHeaderMode headerMode = MPP_ENC_HEADER_MODE_EACH_IDR;
+    if (data->mpi->control(data->ctx, MPP_ENC_SET_HEADER_MODE, &headerMode) != MPP_OK) {
+        CAMERA_LOGW("RkMppEncoder::Open set header mode failed");
+    }
+    if (SetRateControl(config) != RC_OK) {
+        CAMERA_LOGW("RkMppEncoder::Open set rate control failed, keeping the wrapper defaults");
+    }
+
+    config_ = config;
+    idrPending_ = false;
+    frameCount_ = 0;
+    encodeTotalUs_ = 0;
+    encodeMaxUs_ = 0;
+    outputBytes_ = 0;
+    CAMERA_LOGI("RkMppEncoder::Open %{public}s %{public}u x %{public}u type %{public}d multi ctx %{public}d, "
+        "create latency %{public}llu us", RkSocCaps::NAME, config.width, config.height, config.type,
+        RkSocCaps::MPP_MULTI_CTX, static_cast<unsigned long long>(GetMonotonicTimeUs() - begin));
+    return RC_OK;
+}
+
+RetCode RkMppEncoder::SetRateControl(const RkEncoderConfig& config)
+{
+    const RkRateControl& rc = config.rc;
+    uint32_t fps = rc.fps != 0 ? rc.fps : RK_DEFAULT_VIDEO_FPS;
+    uint32_t bps = rc.bitrate != 0 ? rc.bitrate : config.width * config.height / BITS_PER_PIXEL_SECOND_DIV * fps;
+    uint32_t gop = rc.gop != 0 ? rc.gop : fps * DEFAULT_GOP_SECONDS;
+
+    MpiEncTestData* data = RkSocCaps::GetEncData(halCtx_);
+    MppEncCfg cfg = data->cfg;
+    if (data->mpi->control(data->ctx, MPP_ENC_GET_CFG, cfg) != MPP_OK) {
+        return RC_ERROR;
+    }
+    mpp_enc_cfg_set_s32(cfg, "rc:mode", rc.mode);
+    mpp_enc_cfg_set_s32(cfg, "rc:fps_in_num", fps);
+    mpp_enc_cfg_set_s32(cfg, "rc:fps_in_denom", 1);
+    mpp_enc_cfg_set_s32(cfg, "rc:fps_out_num", fps);
+    mpp_enc_cfg_set_s32(cfg, "rc:fps_out_denom", 1);
+    mpp_enc_cfg_set_s32(cfg, "rc:gop", gop);
+    mpp_enc_cfg_set_s32(cfg, "rc:bps_target", bps);
+    if (rc.mode == MPP_ENC_RC_MODE_CBR) {
+        // CBR holds the rate within +-1/16 of the target
+        mpp_enc_cfg_set_s32(cfg, "rc:bps_max", bps / BPS_RANGE_DIV * (BPS_RANGE_DIV + 1));
+        mpp_enc_cfg_set_s32(cfg, "rc:bps_min", bps / BPS_RANGE_DIV * (BPS_RANGE_DIV - 1));
+    } else if (rc.mode == MPP_ENC_RC_MODE_VBR) {
+        // VBR spends what the scene needs up to 1/16 above the target
+        mpp_enc_cfg_set_s32(cfg, "rc:bps_max", bps / BPS_RANGE_DIV * (BPS_RANGE_DIV + 1));
+        mpp_enc_cfg_set_s32(cfg, "rc:bps_min", bps / BPS_RANGE_DIV);
+    } else if (rc.mode == MPP_ENC_RC_MODE_FIXQP) {
+        mpp_enc_cfg_set_s32(cfg, "rc:qp_init", rc.qp);
+        mpp_enc_cfg_set_s32(cfg, "rc:qp_min", rc.qp);
+        mpp_enc_cfg_set_s32(cfg, "rc:qp_max", rc.qp);
+        mpp_enc_cfg_set_s32(cfg, "rc:qp_min_i", rc.qp);
+        mpp_enc_cfg_set_s32(cfg, "rc:qp_max_i", rc.qp);
+        mpp_enc_cfg_set_s32(cfg, "rc:qp_ip", 0);
+    }
+    if (data->mpi->control(data->ctx, MPP_ENC_SET_CFG, cfg) != MPP_OK) {
+        return RC_ERROR;
+    }
+    CAMERA_LOGI("RkMppEncoder rate control mode %{public}d, %{public}u bps, %{public}u fps, gop %{public}u, "
+        "qp %{public}d", rc.mode, bps, fps, gop, rc.qp);
+    return RC_OK;
+}
+
+void RkMppEncoder::Close()
+{
+    if (halCtx_ == nullptr) {
+        return;
+    }
+    ReportLatency();
+    hal_mpp_ctx_delete(halCtx_);
+    halCtx_ = nullptr;
+}
+
+RetCode RkMppEncoder::RequestIdr()
+{
+    if (halCtx_ == nullptr) {
+        return RC_ERROR;
+    }
+    // the first frame of a new session is an IDR anyway
+    idrPending_ = frameCount_ != 0;
+    return RC_OK;
+}
+
+RetCode RkMppEncoder::Encode(int32_t fd, unsigned char* output, size_t& outputSize)
+{
+    if (halCtx_ == nullptr || output == nullptr) {
+        return RC_ERROR;
+    }
+
+    MpiEncTestData* data = RkSocCaps::GetEncData(halCtx_);
+    if (idrPending_) {
+        if (data->mpi->control(data->ctx, MPP_ENC_SET_IDR_FRAME, nullptr) != MPP_OK) {
+            CAMERA_LOGW("RkMppEncoder::Encode request idr failed");
+        }
+        idrPending_ = false;
+    }
+
+    uint64_t begin = GetMonotonicTimeUs();
+    outputSize = data->frame_size;
+    int ret = hal_mpp_encode(halCtx_, fd, output, &outputSize);
+    uint64_t cost = GetMonotonicTimeUs() - begin;
+
+    if (frameCount_ == 0) {
+        firstFrameUs_ = begin;
+    }
+    lastFrameUs_ = begin;
+    outputBytes_ += ret == 0 ? outputSize : 0;
+    frameCount_++;
+    encodeTotalUs_ += cost;
+    encodeMaxUs_ = cost > encodeMaxUs_ ? cost : encodeMaxUs_;
+    if (frameCount_ % LATENCY_REPORT_INTERVAL == 0) {
+        ReportLatency();
+    }
+    if (ret != 0) {
+        CAMERA_LOGE("RkMppEncoder::Encode hal_mpp_encode failed, ret = %{public}d", ret);
+        return RC_ERROR;
+    }
+    return RC_OK;
+}
+
+void RkMppEncoder::ReportLatency() const
+{
+    if (frameCount_ == 0) {
+        return;
+    }
+    // bitrate over the frames encoded so far, compare AVC and HEVC of the same scene by this and the latency
+    uint64_t spanUs = lastFrameUs_ - firstFrameUs_;
+    double fps = spanUs == 0 ? 0 : static_cast<double>(frameCount_ - 1) * TIME_CONVERSION_US_S / spanUs;
+    uint64_t kbps = static_cast<uint64_t>(outputBytes_ / frameCount_ * BITS_PER_BYTE * fps / 1000); // 1000:kbit
+    CAMERA_LOGI("RkMppEncoder type %{public}d frames %{public}llu, encode latency avg %{public}llu us "
+        "max %{public}llu us, %{public}llu bytes per frame, %{public}llu kbps", config_.type,
+        static_cast<unsigned long long>(frameCount_), static_cast<unsigned long long>(encodeTotalUs_ / frameCount_),
+        static_cast<unsigned long long>(encodeMaxUs_), static_cast<unsigned long long>(outputBytes_ / frameCount_),
+        static_cast<unsigned long long>(kbps));
+}
+} // namespace OHOS::Camera
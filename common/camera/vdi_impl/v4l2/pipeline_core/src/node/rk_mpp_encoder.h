@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2024 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HOS_CAMERA_RK_MPP_ENCODER_H
+#define HOS_CAMERA_RK_MPP_ENCODER_H
+
+#include <cstdint>
+#include <cstddef>
+#include "camera.h"
+#include "rk_mpi.h"
+extern "C" {
+#include "mpi_enc_utils.h"
+}
+
+namespace OHOS::Camera {
+static constexpr uint32_t RK_DEFAULT_VIDEO_FPS = 30; // 30:frames per second when the stream does not tell
+
+struct RkRateControl {
+    MppEncRcMode mode = MPP_ENC_RC_MODE_VBR;
+    uint32_t bitrate = 0;   // bits per second, 0: width * height * fps / 8
+    uint32_t fps = RK_DEFAULT_VIDEO_FPS;
+    uint32_t gop = 0;       // frames from one key frame to the next, 0: two seconds
+    int32_t qp = 26;        // 26:QP of every frame in MPP_ENC_RC_MODE_FIXQP
+
+    bool operator==(const RkRateControl& other) const
+    {
+        return mode == other.mode && bitrate == other.bitrate && fps == other.fps && gop == other.gop &&
+            qp == other.qp;
+    }
+    bool operator!=(const RkRateControl& other) const
+    {
+        return !(*this == other);
+    }
+};
+
+struct RkEncoderConfig {
+    uint32_t width = 0;
+    uint32_t height = 0;
+    MppFrameFormat format = MPP_FMT_YUV420P;
+    MppCodingType type = MPP_VIDEO_CodingAVC;
+    RkRateControl rc;
+
+    // rate control is left out, it is changed on a running context
+    bool operator==(const RkEncoderConfig& other) const
+    {
+        return width == other.width && height == other.height && format == other.format && type == other.type;
+    }
+    bool operator!=(const RkEncoderConfig& other) const
+    {
+        return !(*this == other);
+    }
+};
+
+/*
+ * A long-lived MPP encoder session. The context is created once per stream configuration and
+ * only recreated when the size, format or codec changes; rate control is updated in place and
+ * key frames are requested explicitly.
+ * The class is not thread safe, callers serialize access.
+ */
+class RkMppEncoder {
+public:
+    RkMppEncoder() = default;
+    ~RkMppEncoder();
+    RkMppEncoder(const RkMppEncoder&) = delete;
+    RkMppEncoder& operator=(const RkMppEncoder&) = delete;
+
+    RetCode Open(const RkEncoderConfig& config);
+    void Close();
+    bool IsOpen() const
+    {
+        return halCtx_ != nullptr;
+    }
+    RetCode RequestIdr();
+    RetCode Encode(int32_t fd, unsigned char* output, size_t& outputSize);
+
+private:
+    RetCode SetRateControl(const RkEncoderConfig& config);
+    void ReportLatency() const;
+
+    void* halCtx_ = nullptr;
+    MpiEncTestArgs args_ = {};     // the open context points at it until Close()
+    RkEncoderConfig config_ = {};
+    bool idrPending_ = false;
+    uint64_t frameCount_ = 0;
+    uint64_t encodeTotalUs_ = 0;
+    uint64_t encodeMaxUs_ = 0;
+    uint64_t outputBytes_ = 0;
+    uint64_t firstFrameUs_ = 0;
+    uint64_t lastFrameUs_ = 0;
+};
+} // namespace OHOS::Camera
+#endif
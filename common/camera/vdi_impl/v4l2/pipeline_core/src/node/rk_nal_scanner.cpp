@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2024 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "rk_nal_scanner.h"
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace OHOS::Camera {
+static constexpr size_t SCAN_BLOCK_SIZE = 16;     // 16:bytes compared per SIMD step
+static constexpr size_t START_CODE_SIZE = 3;      // 00 00 01
+static constexpr uint8_t H264_NAL_TYPE_MASK = 0x1F;
+static constexpr uint8_t H265_NAL_TYPE_SHIFT = 1;     // forbidden_zero_bit precedes the type
+static constexpr uint8_t H265_NAL_TYPE_MASK = 0x3F;
+
+// true when the 16 bytes at data contain at least one zero byte
+static inline bool BlockHasZero(const uint8_t* data)
+{
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+    uint8x16_t eq = vceqq_u8(vld1q_u8(data), vdupq_n_u8(0));
+    uint8x8_t folded = vorr_u8(vget_low_u8(eq), vget_high_u8(eq));
+    return vget_lane_u64(vreinterpret_u64_u8(folded), 0) != 0;
+#elif defined(__SSE2__)
+    __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(block, _mm_setzero_si128())) != 0;
+#else
+    for (size_t i = 0; i < SCAN_BLOCK_SIZE; i++) {
+        if (data[i] == 0) {
+            return true;
+        }
+    }
+    return false;
+#endif
+}
+
+static inline bool IsStartCode(const uint8_t* data)
+{
+    return data[0] == 0 && data[1] == 0 && data[2] == 1; // 2:third byte of the start code
+}
+
+// position of the next 00 00 01 at or after pos, or size when there is none
+static size_t FindStartCode(const uint8_t* data, size_t size, size_t pos)
+{
+    if (size < START_CODE_SIZE) {
+        return size;
+    }
+    const size_t last = size - START_CODE_SIZE;
+    while (pos + SCAN_BLOCK_SIZE <= last) {
+        // a start code beginning in this block needs a zero inside it
+        if (!BlockHasZero(data + pos)) {
+            pos += SCAN_BLOCK_SIZE;
+            continue;
+        }
+        for (size_t end = pos + SCAN_BLOCK_SIZE; pos < end; pos++) {
+            if (IsStartCode(data + pos)) {
+                return pos;
+            }
+        }
+    }
+    for (; pos <= last; pos++) {
+        if (IsStartCode(data + pos)) {
+            return pos;
+        }
+    }
+    return size;
+}
+
+size_t RkNalScanner::Scan(const uint8_t* data, size_t size, std::vector<RkNalUnit>& units, RkNalCodec codec)
+{
+    units.clear();
+    if (data == nullptr) {
+        return 0;
+    }
+
+    size_t pos = FindStartCode(data, size, 0);
+    while (pos < size) {
+        size_t offset = pos + START_CODE_SIZE;
+        size_t next = FindStartCode(data, size, offset);
+        size_t end = next;
+        // the leading zero of a four byte start code belongs to the next unit
+        if (next < size && end > offset && data[end - 1] == 0) {
+            end--;
+        }
+        if (offset < end) {
+            RkNalUnit unit;
+            unit.type = codec == RK_NAL_H265 ? (data[offset] >> H265_NAL_TYPE_SHIFT) & H265_NAL_TYPE_MASK :
+                data[offset] & H264_NAL_TYPE_MASK;
+            unit.offset = offset;
+            unit.size = end - offset;
+            units.push_back(unit);
+        }
+        pos = next;
+    }
+    return units.size();
+}
+
+bool RkNalScanner::HasKeyFrame(const std::vector<RkNalUnit>& units, RkNalCodec codec)
+{
+    for (const auto& unit : units) {
+        bool key = codec == RK_NAL_H265 ? unit.type >= RK_H265_NAL_BLA_W_LP && unit.type <= RK_H265_NAL_CRA :
+            unit.type == RK_H264_NAL_IDR;
+        if (key) {
+            return true;
+        }
+    }
+    return false;
+}
+} // namespace OHOS::Camera
@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2024 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HOS_CAMERA_RK_NAL_SCANNER_H
+#define HOS_CAMERA_RK_NAL_SCANNER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace OHOS::Camera {
+enum RkH264NalType : uint8_t {
+    RK_H264_NAL_SLICE = 1,
+    RK_H264_NAL_IDR = 5,
+    RK_H264_NAL_SEI = 6,
+    RK_H264_NAL_SPS = 7,
+    RK_H264_NAL_PPS = 8,
+};
+
+enum RkH265NalType : uint8_t {
+    RK_H265_NAL_TRAIL_R = 1,
+    RK_H265_NAL_BLA_W_LP = 16,    // 16..21: IRAP pictures, a decoder can start at any of them
+    RK_H265_NAL_CRA = 21,
+    RK_H265_NAL_VPS = 32,
+    RK_H265_NAL_SPS = 33,
+    RK_H265_NAL_PPS = 34,
+    RK_H265_NAL_SEI_PREFIX = 39,
+};
+
+enum RkNalCodec : uint8_t {
+    RK_NAL_H264 = 0,
+    RK_NAL_H265,
+};
+
+struct RkNalUnit {
+    uint8_t type = 0;     // nal_unit_type
+    size_t offset = 0;    // first byte of the NAL header, after the start code
+    size_t size = 0;      // header and payload, without the start code of the next unit
+};
+
+/*
+ * Splits an Annex-B H.264 or H.265 byte stream into NAL units. Runs of bytes without a zero are skipped 16 at a
+ * time with NEON or SSE2, only candidate positions are checked for a 00 00 01 start code.
+ */
+class RkNalScanner {
+public:
+    // fills units and returns their count, units is reused by the caller to avoid allocations
+    static size_t Scan(const uint8_t* data, size_t size, std::vector<RkNalUnit>& units,
+        RkNalCodec codec = RK_NAL_H264);
+    // an H.264 IDR, or an H.265 IRAP picture (BLA, IDR or CRA)
+    static bool HasKeyFrame(const std::vector<RkNalUnit>& units, RkNalCodec codec = RK_NAL_H264);
+};
+} // namespace OHOS::Camera
+#endif
@@ -0,0 +1,383 @@
+/*
+ * Copyright (c) 2024 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "rk_node_utils.h"
+#include "rk_transform_planner.h"
+#include "map"
+#include "camera.h"
+#include "source_node.h"
+#include "RockchipRga.h"
+#include "RgaUtils.h"
+#include "RgaApi.h"
+#include "rk_mpi.h"
+#include "mutex"
+#include "atomic"
+namespace OHOS::Camera {
+using namespace std;
+static uint32_t ConvertOhosFormat2RkFormat(uint32_t format)
+{
+    static map<uint32_t, uint32_t> ohosFormat2AVPixelFormatMap = {
+        {CAMERA_FORMAT_RGBA_8888,    RK_FORMAT_RGBA_8888},
+        {CAMERA_FORMAT_RGB_888,      RK_FORMAT_RGB_888},
+        {CAMERA_FORMAT_YCRCB_420_SP, RK_FORMAT_YCbCr_420_SP},
+        {CAMERA_FORMAT_YCRCB_420_P,  RK_FORMAT_YCbCr_420_P},
+    };
+    auto it = ohosFormat2AVPixelFormatMap.find(format);
+    if (it != ohosFormat2AVPixelFormatMap.end()) {
+        return it->second;
+    }
+    return RK_FORMAT_UNKNOWN;
+}
+
+static int32_t ConvertRotation2RgaTransform(uint32_t rotation)
+{
+    switch (rotation) {
+        case 90: // 90:degrees clockwise
+            return HAL_TRANSFORM_ROT_90;
+        case 180: // 180:degrees clockwise
+            return HAL_TRANSFORM_ROT_180;
+        case 270: // 270:degrees clockwise
+            return HAL_TRANSFORM_ROT_270;
+        default:
+            return 0;
+    }
+}
+
+static bool CheckIfNeedDoTransform(std::shared_ptr<IBuffer>& buffer, uint32_t format, bool flagToFd,
+    int32_t rgaRotation)
+{
+    if (buffer == nullptr) {
+        CAMERA_LOGE("BufferScaleFormatTransform Error buffer == nullptr");
+        return false;
+    }
+    CAMERA_LOGD("BufferScaleFormatTransform, \
+streamId[%d], index[%d], %d * %d ==> %d * %d, format: %d ==> %d , encodeType: %d",
+        buffer->GetStreamId(), buffer->GetIndex(),
+        buffer->GetCurWidth(), buffer->GetCurHeight(), buffer->GetWidth(), buffer->GetHeight(),
+        buffer->GetCurFormat(), format, buffer->GetEncodeType());
+
+    if (buffer->GetCurWidth() == buffer->GetWidth()
+        && buffer->GetCurHeight() == buffer->GetHeight()
+        && buffer->GetCurFormat() == format
+        && rgaRotation == 0
+        && (!flagToFd || buffer->GetIsValidDataInSurfaceBuffer())) {
+            CAMERA_LOGE("no need ImageFormatConvert, nothing to do");
+            return false;
+    }
+
+    auto srcRkFmt = ConvertOhosFormat2RkFormat(buffer->GetCurFormat());
+    auto dstRkFmt = ConvertOhosFormat2RkFormat(format);
+    if (srcRkFmt == RK_FORMAT_UNKNOWN || dstRkFmt == RK_FORMAT_UNKNOWN) {
+        CAMERA_LOGE("RkNodeUtils::BufferScaleFormatTransform Error, not support format: %{public}d -> %{public}d",
+            buffer->GetCurFormat(), format);
+        return false;
+    }
+    return true;
+}
+
+static size_t GetRgaImageSize(const RkBlitImage& image)
+{
+    return static_cast<size_t>(get_bpp_from_format(image.rkFmt) * image.width * image.height);
+}
+
+RkRgaContext::RkRgaContext()
+{
+    if (RkRgaBlitBackend::IsAvailable()) {
+        rga_ = std::make_unique<RkRgaBlitBackend>();
+    } else {
+        CAMERA_LOGW("RkRgaContext: no RGA device, blits run on the %{public}s backend", cpu_.GetName());
+    }
+}
+
+/*
+ * Jobs queued on RGA by all contexts and not flushed yet. Past RGA_MAX_QUEUED_JOBS a new job would only
+ * wait behind the others, so it runs on the CPU backend instead.
+ */
+static std::atomic<uint32_t> g_rgaQueuedJobs = 0;
+static constexpr uint32_t RGA_MAX_QUEUED_JOBS = 6; // 6:three streams with a staging pass and a frame each
+
+RetCode RkRgaContext::Blit(const RkBlitImage& src, const RkBlitImage& dst, int32_t rotation)
+{
+    if (rga_ != nullptr) {
+        if (g_rgaQueuedJobs.load() >= RGA_MAX_QUEUED_JOBS) {
+            CAMERA_LOGD("RkRgaContext::Blit rga queue full, %{public}u x %{public}u -> %{public}u x %{public}u "
+                "runs on %{public}s", src.width, src.height, dst.width, dst.height, cpu_.GetName());
+        } else if (rga_->Blit(src, dst, rotation) == RC_OK) {
+            queuedJobs_++;
+            g_rgaQueuedJobs++;
+            return RC_OK;
+        } else {
+            CAMERA_LOGW("RkRgaContext::Blit rga rejected %{public}u x %{public}u -> %{public}u x %{public}u, "
+                "falling back to %{public}s", src.width, src.height, dst.width, dst.height, cpu_.GetName());
+        }
+        // earlier jobs of this context may still be writing the images the CPU is about to read
+        Flush();
+    }
+    RkDmaBufBeginCpuAccess(src.fd);
+    RkDmaBufBeginCpuAccess(dst.fd);
+    RetCode rc = cpu_.Blit(src, dst, rotation);
+    cpuCopyBytes_ += rc == RC_OK ? GetRgaImageSize(dst) : 0;
+    RkDmaBufEndCpuAccess(dst.fd);
+    RkDmaBufEndCpuAccess(src.fd);
+    return rc;
+}
+
+uint64_t RkRgaContext::TakeCpuCopyBytes()
+{
+    uint64_t bytes = cpuCopyBytes_;
+    cpuCopyBytes_ = 0;
+    return bytes;
+}
+
+void RkRgaContext::Flush()
+{
+    if (rga_ != nullptr && queuedJobs_ != 0) {
+        rga_->Flush();
+        g_rgaQueuedJobs -= queuedJobs_;
+        queuedJobs_ = 0;
+    }
+}
+
+/*
+ * RGA can not blit in place, so a frame whose source and destination share the same memory is first
+ * moved by RGA into a staging area: the (currently unused) surface dma-buf when it is large enough,
+ * otherwise the scratch buffer of the stream's RGA context. No CPU copy is made on either path
+ * unless the CPU backend stands in for RGA.
+ */
+void RkRgaContext::UseScratchBuffer(RkBlitImage& image)
+{
+    RkBufferPool::GetInstance().Reserve(scratch_, GetRgaImageSize(image), RK_POOL_DMA);
+    image.fd = scratch_.GetFd();
+    image.virAddr = scratch_.GetData();
+}
+
+// 90 and 270 degrees swap the target width and height
+static void GetRotatedSize(std::shared_ptr<IBuffer>& buffer, int32_t rgaRotation, uint32_t& width, uint32_t& height)
+{
+    bool swap = rgaRotation == HAL_TRANSFORM_ROT_90 || rgaRotation == HAL_TRANSFORM_ROT_270;
+    width = swap ? buffer->GetHeight() : buffer->GetWidth();
+    height = swap ? buffer->GetWidth() : buffer->GetHeight();
+}
+
+// both count the RGA jobs run in passes; on error the frame is where it was and the buffer is left as it is
+static RetCode TransformToVirAddress(RkRgaContext& context, std::shared_ptr<IBuffer>& buffer,
+    int32_t srcRkFmt, int32_t dstRkFmt, int32_t rgaRotation, uint32_t& passes)
+{
+    RkBlitImage src = {-1, buffer->GetVirAddress(), buffer->GetCurWidth(), buffer->GetCurHeight(), srcRkFmt};
+    RkBlitImage dst = {-1, buffer->GetVirAddress(), 0, 0, dstRkFmt};
+    GetRotatedSize(buffer, rgaRotation, dst.width, dst.height);
+    passes = 0;
+
+    if (buffer->GetIsValidDataInSurfaceBuffer()) {
+        src.fd = buffer->GetFileDescriptor();
+        src.virAddr = buffer->GetSuffaceBufferAddr();
+    } else {
+        RkBlitImage staging = src;
+        if (buffer->GetFileDescriptor() >= 0 && buffer->GetSuffaceBufferSize() >= GetRgaImageSize(src)) {
+            staging.fd = buffer->GetFileDescriptor();
+            staging.virAddr = buffer->GetSuffaceBufferAddr();
+        } else {
+            context.UseScratchBuffer(staging);
+        }
+        passes++;
+        if (context.Blit(src, staging) != RC_OK) {
+            return RC_ERROR;
+        }
+        src = staging;
+    }
+
+    passes++;
+    if (context.Blit(src, dst, rgaRotation) != RC_OK) {
+        return RC_ERROR;
+    }
+    buffer->SetIsValidDataInSurfaceBuffer(false);
+    return RC_OK;
+}
+
+static RetCode TransformToFd(RkRgaContext& context, std::shared_ptr<IBuffer>& buffer,
+    int32_t srcRkFmt, int32_t dstRkFmt, int32_t rgaRotation, uint32_t& passes)
+{
+    RkBlitImage src = {-1, buffer->GetVirAddress(), buffer->GetCurWidth(), buffer->GetCurHeight(), srcRkFmt};
+    RkBlitImage dst = {buffer->GetFileDescriptor(), buffer->GetSuffaceBufferAddr(), 0, 0, dstRkFmt};
+    GetRotatedSize(buffer, rgaRotation, dst.width, dst.height);
+    passes = 0;
+
+    if (buffer->GetIsValidDataInSurfaceBuffer()) {
+        RkBlitImage surface = src;
+        surface.fd = buffer->GetFileDescriptor();
+        surface.virAddr = buffer->GetSuffaceBufferAddr();
+        passes++;
+        if (context.Blit(surface, src) != RC_OK) {
+            return RC_ERROR;
+        }
+    }
+
+    passes++;
+    if (context.Blit(src, dst, rgaRotation) != RC_OK) {
+        return RC_ERROR;
+    }
+    buffer->SetIsValidDataInSurfaceBuffer(true);
+    return RC_OK;
+}
+
+RkRgaFence::RkRgaFence(std::shared_ptr<RkRgaContext> context, std::unique_lock<std::mutex> lock)
+    : context_(context), lock_(std::move(lock))
+{
+}
+
+RkRgaFence::~RkRgaFence()
+{
+    Wait();
+}
+
+void RkRgaFence::Wait()
+{
+    if (context_ == nullptr) {
+        return;
+    }
+    context_->Flush();
+    if (lock_.owns_lock()) {
+        lock_.unlock();
+    }
+    context_ = nullptr;
+}
+
+static std::mutex g_rgaContextsLock;
+static map<int32_t, std::shared_ptr<RkRgaContext>> g_rgaContexts;
+
+std::shared_ptr<RkRgaContext> RkNodeUtils::GetRgaContext(int32_t streamId)
+{
+    std::lock_guard<std::mutex> l(g_rgaContextsLock);
+    auto it = g_rgaContexts.find(streamId);
+    if (it != g_rgaContexts.end()) {
+        return it->second;
+    }
+    auto context = std::make_shared<RkRgaContext>();
+    g_rgaContexts[streamId] = context;
+    CAMERA_LOGI("RkNodeUtils::GetRgaContext create rga context for streamId[%{public}d]", streamId);
+    return context;
+}
+
+void RkNodeUtils::ReleaseRgaContext(int32_t streamId)
+{
+    std::lock_guard<std::mutex> l(g_rgaContextsLock);
+    g_rgaContexts.erase(streamId);
+}
+
+RkRgaFence RkNodeUtils::BufferScaleFormatTransformAsync(std::shared_ptr<IBuffer>& buffer, bool flagToFd,
+    uint32_t rotation)
+{
+    if (buffer == nullptr) {
+        CAMERA_LOGE("BufferScaleFormatTransform Error buffer == nullptr");
+        return RkRgaFence();
+    }
+    return BufferScaleFormatTransformAsync(buffer, buffer->GetFormat(), flagToFd, rotation);
+}
+
+RkRgaFence RkNodeUtils::BufferScaleFormatTransformAsync(std::shared_ptr<IBuffer>& buffer, uint32_t format,
+    bool flagToFd, uint32_t rotation)
+{
+    int32_t rgaRotation = ConvertRotation2RgaTransform(rotation);
+    if (!CheckIfNeedDoTransform(buffer, format, flagToFd, rgaRotation)) {
+        return RkRgaFence();
+    }
+    auto srcRkFmt = ConvertOhosFormat2RkFormat(buffer->GetCurFormat());
+    auto dstRkFmt = ConvertOhosFormat2RkFormat(format);
+
+    auto context = GetRgaContext(buffer->GetStreamId());
+    std::unique_lock<std::mutex> l(context->GetLock());
+    uint32_t passes = 0;
+    RetCode rc = flagToFd ? TransformToFd(*context, buffer, srcRkFmt, dstRkFmt, rgaRotation, passes) :
+        TransformToVirAddress(*context, buffer, srcRkFmt, dstRkFmt, rgaRotation, passes);
+    RkTransformPlanner::GetInstance().AddPasses(buffer->GetStreamId(), passes, context->TakeCpuCopyBytes());
+    if (rc != RC_OK) {
+        // neither RGA nor the CPU took the job, whatever reached the target is not the converted frame
+        CAMERA_LOGE("RkNodeUtils::BufferScaleFormatTransform streamId[%{public}d] index[%{public}d] "
+            "%{public}d -> %{public}d failed", buffer->GetStreamId(), buffer->GetIndex(), buffer->GetCurFormat(),
+            format);
+        buffer->SetBufferStatus(CAMERA_BUFFER_STATUS_INVALID);
+        return RkRgaFence(context, std::move(l));
+    }
+
+    uint32_t width = 0;
+    uint32_t height = 0;
+    GetRotatedSize(buffer, rgaRotation, width, height);
+    buffer->SetCurFormat(format);
+    buffer->SetCurWidth(width);
+    buffer->SetCurHeight(height);
+    return RkRgaFence(context, std::move(l));
+}
+
+void RkNodeUtils::BufferScaleFormatTransform(std::shared_ptr<IBuffer>& buffer, bool flagToFd, uint32_t rotation)
+{
+    RkRgaFence fence = BufferScaleFormatTransformAsync(buffer, flagToFd, rotation);
+    fence.Wait();
+}
+
+RetCode RkNodeUtils::BufferCopyFrameAsync(std::shared_ptr<IBuffer>& buffer, std::shared_ptr<RkRgaContext> context,
+    RkPoolBuffer& memory, RkBlitImage& image, RkRgaFence& fence)
+{
+    int32_t rkFmt = static_cast<int32_t>(ConvertOhosFormat2RkFormat(buffer->GetCurFormat()));
+    if (rkFmt == RK_FORMAT_UNKNOWN) {
+        CAMERA_LOGE("RkNodeUtils::BufferCopyFrameAsync not support format: %{public}d", buffer->GetCurFormat());
+        return RC_ERROR;
+    }
+    RkBlitImage src = {-1, buffer->GetVirAddress(), buffer->GetCurWidth(), buffer->GetCurHeight(), rkFmt};
+    if (buffer->GetIsValidDataInSurfaceBuffer()) {
+        src.fd = buffer->GetFileDescriptor();
+        src.virAddr = buffer->GetSuffaceBufferAddr();
+    }
+    RkBufferPool::GetInstance().Reserve(memory, GetRgaImageSize(src), RK_POOL_DMA);
+    image = {memory.GetFd(), memory.GetData(), src.width, src.height, rkFmt};
+
+    std::unique_lock<std::mutex> l(context->GetLock());
+    RetCode rc = context->Blit(src, image);
+    RkTransformPlanner::GetInstance().AddPasses(buffer->GetStreamId(), 1, context->TakeCpuCopyBytes());
+    fence = RkRgaFence(context, std::move(l));
+    return rc;
+}
+
+RetCode RkNodeUtils::BufferLoadFrame(std::shared_ptr<IBuffer>& buffer, const RkBlitImage& image, uint32_t format,
+    uint32_t rotation)
+{
+    int32_t rkFmt = static_cast<int32_t>(ConvertOhosFormat2RkFormat(format));
+    if (rkFmt == RK_FORMAT_UNKNOWN) {
+        CAMERA_LOGE("RkNodeUtils::BufferLoadFrame not support format: %{public}d", format);
+        return RC_ERROR;
+    }
+    int32_t rgaRotation = ConvertRotation2RgaTransform(rotation);
+    RkBlitImage dst = {-1, buffer->GetVirAddress(), 0, 0, rkFmt};
+    GetRotatedSize(buffer, rgaRotation, dst.width, dst.height);
+
+    auto context = GetRgaContext(buffer->GetStreamId());
+    std::lock_guard<std::mutex> l(context->GetLock());
+    RetCode rc = context->Blit(image, dst, rgaRotation);
+    context->Flush();
+    RkTransformPlanner::GetInstance().AddPasses(buffer->GetStreamId(), 1, context->TakeCpuCopyBytes());
+    if (rc != RC_OK) {
+        return rc;
+    }
+    buffer->SetCurFormat(format);
+    buffer->SetCurWidth(dst.width);
+    buffer->SetCurHeight(dst.height);
+    buffer->SetIsValidDataInSurfaceBuffer(false);
+    return RC_OK;
+}
+
+void RkNodeUtils::BufferScaleFormatTransform(std::shared_ptr<IBuffer>& buffer, uint32_t format, bool flagToFd,
+    uint32_t rotation)
+{
+    RkRgaFence fence = BufferScaleFormatTransformAsync(buffer, format, flagToFd, rotation);
+    fence.Wait();
+}
+};
\ No newline at end of file
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2024 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __RK_NODE_UTILS_H__
+#define __RK_NODE_UTILS_H__
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "ibuffer.h"
+#include "rk_blit_backend.h"
+#include "rk_buffer_pool.h"
+#include "rk_cpu_blit.h"
+namespace OHOS::Camera {
+    // A long-lived RGA session. Every stream owns one, so streams no longer wait on each other.
+    class RkRgaContext {
+    public:
+        RkRgaContext();
+        std::mutex& GetLock()
+        {
+            return lock_;
+        }
+        // RGA when the board has it, accepts the job and its queue is not full, the CPU backend otherwise
+        RetCode Blit(const RkBlitImage& src, const RkBlitImage& dst, int32_t rotation = 0);
+        void Flush();
+        // points image at the scratch dma-buf of this context, grown from the buffer pool as needed
+        void UseScratchBuffer(RkBlitImage& image);
+        // bytes the CPU backend wrote since the last call
+        uint64_t TakeCpuCopyBytes();
+
+    private:
+        std::mutex lock_;
+        std::unique_ptr<RkRgaBlitBackend> rga_ = nullptr;
+        RkCpuBlitBackend cpu_;
+        RkPoolBuffer scratch_;
+        uint64_t cpuCopyBytes_ = 0;
+        uint32_t queuedJobs_ = 0;     // RGA jobs submitted since the last flush
+    };
+
+    // Completion of an asynchronous blit. The context stays locked until Wait() returns,
+    // Wait() must be called from the submitting thread.
+    class RkRgaFence {
+    public:
+        RkRgaFence() = default;
+        RkRgaFence(std::shared_ptr<RkRgaContext> context, std::unique_lock<std::mutex> lock);
+        RkRgaFence(RkRgaFence&& other) = default;
+        RkRgaFence& operator=(RkRgaFence&& other) = default;
+        ~RkRgaFence();
+        void Wait();
+
+    private:
+        std::shared_ptr<RkRgaContext> context_ = nullptr;
+        std::unique_lock<std::mutex> lock_;
+    };
+
+    class RkNodeUtils {
+    public:
+        // rotation is clockwise in degrees (0, 90, 180 or 270) and is applied in the same RGA pass,
+        // the current width and height of a buffer rotated by 90 or 270 degrees are swapped.
+        // With flagToFd the frame always ends in the surface dma-buf, RGA copies it there when there is
+        // nothing to convert, so the fd goes on to MPP or the consumer and nobody copies it on the CPU
+        static void BufferScaleFormatTransform(std::shared_ptr<IBuffer>& buffer, bool flagToFd = true,
+            uint32_t rotation = 0);
+        static RkRgaFence BufferScaleFormatTransformAsync(std::shared_ptr<IBuffer>& buffer, bool flagToFd = true,
+            uint32_t rotation = 0);
+        // converts to format instead of the format of the buffer, which is left as it is
+        static void BufferScaleFormatTransform(std::shared_ptr<IBuffer>& buffer, uint32_t format, bool flagToFd,
+            uint32_t rotation = 0);
+        static RkRgaFence BufferScaleFormatTransformAsync(std::shared_ptr<IBuffer>& buffer, uint32_t format,
+            bool flagToFd, uint32_t rotation = 0);
+        // queues the copy of the current frame of buffer into memory, a dma-buf of the pool, on context and
+        // describes it in image; the frame must stay as it is until fence has been waited on
+        static RetCode BufferCopyFrameAsync(std::shared_ptr<IBuffer>& buffer, std::shared_ptr<RkRgaContext> context,
+            RkPoolBuffer& memory, RkBlitImage& image, RkRgaFence& fence);
+        // replaces the frame of buffer by image, scaled to the buffer size, converted to format and rotated
+        // in one RGA pass into its virAddr
+        static RetCode BufferLoadFrame(std::shared_ptr<IBuffer>& buffer, const RkBlitImage& image, uint32_t format,
+            uint32_t rotation = 0);
+        static std::shared_ptr<RkRgaContext> GetRgaContext(int32_t streamId);
+        static void ReleaseRgaContext(int32_t streamId);
+    };
+};
+
+#endif
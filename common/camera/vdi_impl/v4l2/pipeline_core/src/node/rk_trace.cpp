@@ -0,0 +1,270 @@
+/*
+ * Copyright (c) 2024 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "rk_trace.h"
+
+#ifdef RK_CAMERA_TRACE
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <ctime>
+#include <map>
+#include <string>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "camera.h"
+
+namespace OHOS::Camera {
+static constexpr const char* TRACE_DIR = "/data/local/tmp";
+static constexpr double NS_PER_US = 1000.0;
+static constexpr double NS_PER_MS = 1000000.0;
+static constexpr double NS_PER_S = 1000000000.0;
+static constexpr uint32_t P50 = 50;
+static constexpr uint32_t P99 = 99;
+static constexpr uint32_t PERCENT = 100;
+
+RkTracer& RkTracer::GetInstance()
+{
+    // never destroyed, threads may still record while the process exits
+    static RkTracer* instance = new RkTracer();
+    return *instance;
+}
+
+uint64_t RkTracer::Now()
+{
+    struct timespec ts = {};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec; // 1000000000:ns per second
+}
+
+RkTracer::RingHolder::~RingHolder()
+{
+    if (ring != nullptr) {
+        std::lock_guard<std::mutex> l(RkTracer::GetInstance().lock_);
+        ring->inUse = false;
+    }
+}
+
+RkTraceRing* RkTracer::GetRing()
+{
+    static thread_local RingHolder holder;
+    if (holder.ring == nullptr) {
+        holder.ring = AcquireRing();
+    }
+    return holder.ring;
+}
+
+RkTraceRing* RkTracer::AcquireRing()
+{
+    uint32_t tid = static_cast<uint32_t>(syscall(SYS_gettid));
+    std::lock_guard<std::mutex> l(lock_);
+    for (auto& ring : rings_) {
+        if (!ring->inUse) {
+            // the events of the thread that exited go, they would be read as events of this one
+            ring->inUse = true;
+            ring->tid = tid;
+            ring->head.store(0, std::memory_order_relaxed);
+            return ring.get();
+        }
+    }
+    auto ring = std::make_unique<RkTraceRing>();
+    ring->tid = tid;
+    rings_.push_back(std::move(ring));
+    return rings_.back().get();
+}
+
+void RkTracer::Record(const RkTraceEvent& event)
+{
+    RkTraceRing* ring = GetRing();
+    uint64_t head = ring->head.load(std::memory_order_relaxed);
+    ring->events[head % RkTraceRing::CAPACITY] = event;
+    ring->head.store(head + 1, std::memory_order_release);
+}
+
+void RkTracer::Collect(std::vector<std::pair<uint32_t, RkTraceEvent>>& events)
+{
+    std::lock_guard<std::mutex> l(lock_);
+    for (auto& ring : rings_) {
+        uint64_t head = ring->head.load(std::memory_order_acquire);
+        uint64_t first = head > RkTraceRing::CAPACITY ? head - RkTraceRing::CAPACITY : 0;
+        size_t start = events.size();
+        for (uint64_t i = first; i < head; i++) {
+            events.push_back({ring->tid, ring->events[i % RkTraceRing::CAPACITY]});
+        }
+        // the owner kept writing while we copied, drop the slots it may have overwritten
+        uint64_t after = ring->head.load(std::memory_order_acquire);
+        uint64_t valid = after >= RkTraceRing::CAPACITY ? after - RkTraceRing::CAPACITY + 1 : 0;
+        if (valid > first) {
+            size_t drop = std::min<uint64_t>(valid - first, head - first);
+            events.erase(events.begin() + start, events.begin() + start + drop);
+        }
+    }
+}
+
+namespace {
+struct NodeStats {
+    std::vector<uint64_t> self;     // time in the node itself
+    std::vector<uint64_t> total;    // including the nodes it delivered to on the same thread
+    uint64_t firstNs = UINT64_MAX;
+    uint64_t lastNs = 0;
+};
+
+struct CounterStats {
+    int64_t max = 0;
+    int64_t sum = 0;
+    uint64_t count = 0;
+};
+}
+
+static double Percentile(std::vector<uint64_t>& values, uint32_t percent)
+{
+    if (values.empty()) {
+        return 0;
+    }
+    size_t index = (values.size() - 1) * percent / PERCENT;
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index] / NS_PER_MS;
+}
+
+// nodes deliver to the next node from inside DeliverBuffer, so scopes nest on a thread
+static void AddSelfTimes(std::vector<std::pair<uint32_t, RkTraceEvent>>& events,
+    std::map<std::string, NodeStats>& nodes)
+{
+    std::sort(events.begin(), events.end(), [](const auto& a, const auto& b) {
+        if (a.first != b.first) {
+            return a.first < b.first;
+        }
+        if (a.second.beginNs != b.second.beginNs) {
+            return a.second.beginNs < b.second.beginNs;
+        }
+        return a.second.endNs > b.second.endNs;
+    });
+    struct Open {
+        const RkTraceEvent* event;
+        uint64_t children;
+    };
+    std::vector<Open> stack;
+    uint32_t tid = UINT32_MAX;
+    auto close = [&nodes](const Open& open) {
+        NodeStats& node = nodes[open.event->name];
+        uint64_t duration = open.event->endNs - open.event->beginNs;
+        node.total.push_back(duration);
+        node.self.push_back(duration - std::min(duration, open.children));
+        node.firstNs = std::min(node.firstNs, open.event->beginNs);
+        node.lastNs = std::max(node.lastNs, open.event->endNs);
+    };
+    for (auto& [eventTid, event] : events) {
+        if (event.value >= 0) {
+            continue;
+        }
+        if (eventTid != tid) {
+            for (; !stack.empty(); stack.pop_back()) {
+                close(stack.back());
+            }
+            tid = eventTid;
+        }
+        while (!stack.empty() && stack.back().event->endNs <= event.beginNs) {
+            close(stack.back());
+            stack.pop_back();
+        }
+        if (!stack.empty()) {
+            stack.back().children += event.endNs - event.beginNs;
+        }
+        stack.push_back({&event, 0});
+    }
+    for (; !stack.empty(); stack.pop_back()) {
+        close(stack.back());
+    }
+}
+
+static void WriteChromeTrace(const std::vector<std::pair<uint32_t, RkTraceEvent>>& events)
+{
+    static uint32_t sequence = 0;
+    std::string path = std::string(TRACE_DIR) + "/rk_camera_trace_" + std::to_string(getpid()) + "_" +
+        std::to_string(sequence++) + ".json";
+    FILE* file = fopen(path.c_str(), "w");
+    if (file == nullptr) {
+        CAMERA_LOGE("RkTracer: can not write %{public}s", path.c_str());
+        return;
+    }
+    fprintf(file, "{\"traceEvents\":[\n");
+    const char* separator = "";
+    for (auto& [tid, event] : events) {
+        if (event.value >= 0) {
+            fprintf(file, "%s{\"name\":\"%s\",\"ph\":\"C\",\"ts\":%.3f,\"pid\":%d,\"tid\":%u,"
+                "\"args\":{\"value\":%" PRId64 "}}", separator, event.name, event.beginNs / NS_PER_US,
+                getpid(), tid, event.value);
+        } else {
+            fprintf(file, "%s{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,\"tid\":%u,"
+                "\"args\":{\"frame\":%" PRIu64 ",\"stream\":%d}}", separator, event.name,
+                event.beginNs / NS_PER_US, (event.endNs - event.beginNs) / NS_PER_US, getpid(), tid,
+                event.frame, event.streamId);
+        }
+        separator = ",\n";
+    }
+    fprintf(file, "\n]}\n");
+    fclose(file);
+    CAMERA_LOGI("RkTracer: %{public}zu events written to %{public}s", events.size(), path.c_str());
+}
+
+void RkTracer::Dump()
+{
+    std::vector<std::pair<uint32_t, RkTraceEvent>> events;
+    Collect(events);
+    if (events.empty()) {
+        return;
+    }
+    WriteChromeTrace(events);
+
+    std::map<std::string, CounterStats> counters;
+    std::map<std::pair<int32_t, uint64_t>, std::pair<uint64_t, uint64_t>> frames;
+    for (auto& [tid, event] : events) {
+        if (event.value >= 0) {
+            CounterStats& counter = counters[event.name];
+            counter.max = std::max(counter.max, event.value);
+            counter.sum += event.value;
+            counter.count++;
+            continue;
+        }
+        auto [it, added] = frames.try_emplace({event.streamId, event.frame}, event.beginNs, event.endNs);
+        if (!added) {
+            it->second.first = std::min(it->second.first, event.beginNs);
+            it->second.second = std::max(it->second.second, event.endNs);
+        }
+    }
+
+    std::map<std::string, NodeStats> nodes;
+    AddSelfTimes(events, nodes);
+    for (auto& [name, node] : nodes) {
+        double seconds = (node.lastNs - node.firstNs) / NS_PER_S;
+        double fps = seconds > 0 ? (node.self.size() - 1) / seconds : 0;
+        CAMERA_LOGI("RkTracer %{public}s: %{public}zu frames, %{public}.1f fps, self p50 %{public}.2f ms "
+            "p99 %{public}.2f ms, with downstream p50 %{public}.2f ms p99 %{public}.2f ms", name.c_str(),
+            node.self.size(), fps, Percentile(node.self, P50), Percentile(node.self, P99),
+            Percentile(node.total, P50), Percentile(node.total, P99));
+    }
+    for (auto& [name, counter] : counters) {
+        CAMERA_LOGI("RkTracer %{public}s: max %{public}" PRId64 ", mean %{public}.1f", name.c_str(),
+            counter.max, static_cast<double>(counter.sum) / counter.count);
+    }
+    std::map<int32_t, std::vector<uint64_t>> latencies;
+    for (auto& [key, span] : frames) {
+        latencies[key.first].push_back(span.second - span.first);
+    }
+    for (auto& [streamId, latency] : latencies) {
+        CAMERA_LOGI("RkTracer stream %{public}d: %{public}zu frames, pipeline p50 %{public}.2f ms p99 %{public}.2f ms",
+            streamId, latency.size(), Percentile(latency, P50), Percentile(latency, P99));
+    }
+}
+} // namespace OHOS::Camera
+#endif
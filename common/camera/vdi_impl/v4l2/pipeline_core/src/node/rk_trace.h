@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2024 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HOS_CAMERA_RK_TRACE_H
+#define HOS_CAMERA_RK_TRACE_H
+
+/*
+ * Per-node frame tracing, built only with rk_camera_trace = true (RK_CAMERA_TRACE). Otherwise the
+ * macros expand to nothing and their arguments are not evaluated.
+ *
+ *   RK_TRACE_SCOPE("RKCodecNode", buffer);          enter/exit of a node for one frame
+ *   RK_TRACE_COUNTER("h264 in flight", depth);      a queue depth or other counter sample
+ *   RK_TRACE_DUMP();                                 write a Chrome trace and log p50/p99 per node
+ */
+#ifdef RK_CAMERA_TRACE
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "ibuffer.h"
+
+namespace OHOS::Camera {
+struct RkTraceEvent {
+    const char* name;       // string literal
+    uint64_t frame;
+    int32_t streamId;
+    uint64_t beginNs;
+    uint64_t endNs;         // equals beginNs for counters
+    int64_t value;          // counter value, -1 for scopes
+};
+
+// Written by its thread only, read by the dumper without locks. Once its thread has exited the ring
+// goes to the next thread that records, so there are only as many rings as threads alive at once.
+struct RkTraceRing {
+    static constexpr uint32_t CAPACITY = 8192; // 8192:events kept per thread
+    uint32_t tid = 0;
+    bool inUse = true;      // under RkTracer::lock_
+    std::atomic<uint64_t> head = 0;
+    RkTraceEvent events[CAPACITY];
+};
+
+class RkTracer {
+public:
+    static RkTracer& GetInstance();
+    static uint64_t Now();
+    void Record(const RkTraceEvent& event);
+    // writes a Chrome trace (chrome://tracing, ui.perfetto.dev) and logs the per-node statistics
+    void Dump();
+
+private:
+    // hands the ring of a thread back when the thread exits
+    struct RingHolder {
+        RkTraceRing* ring = nullptr;
+        ~RingHolder();
+    };
+
+    RkTracer() = default;
+    RkTraceRing* GetRing();
+    RkTraceRing* AcquireRing();
+    void Collect(std::vector<std::pair<uint32_t, RkTraceEvent>>& events);
+
+    std::mutex lock_;
+    std::vector<std::unique_ptr<RkTraceRing>> rings_;
+};
+
+class RkTraceScope {
+public:
+    RkTraceScope(const char* name, const std::shared_ptr<IBuffer>& buffer)
+        : name_(name), beginNs_(RkTracer::Now())
+    {
+        if (buffer != nullptr) {
+            frame_ = buffer->GetFrameNumber();
+            streamId_ = buffer->GetStreamId();
+        }
+    }
+    ~RkTraceScope()
+    {
+        RkTracer::GetInstance().Record({name_, frame_, streamId_, beginNs_, RkTracer::Now(), -1});
+    }
+
+private:
+    const char* name_;
+    uint64_t beginNs_;
+    uint64_t frame_ = 0;
+    int32_t streamId_ = -1;
+};
+} // namespace OHOS::Camera
+
+#define RK_TRACE_CONCAT_INNER(a, b) a##b
+#define RK_TRACE_CONCAT(a, b) RK_TRACE_CONCAT_INNER(a, b)
+#define RK_TRACE_SCOPE(name, buffer) \
+    OHOS::Camera::RkTraceScope RK_TRACE_CONCAT(rkTraceScope, __LINE__)((name), (buffer))
+#define RK_TRACE_COUNTER(name, value) do { \
+        uint64_t rkTraceNow = OHOS::Camera::RkTracer::Now(); \
+        OHOS::Camera::RkTracer::GetInstance().Record({(name), 0, -1, rkTraceNow, rkTraceNow, \
+            static_cast<int64_t>(value)}); \
+    } while (0)
+#define RK_TRACE_DUMP() OHOS::Camera::RkTracer::GetInstance().Dump()
+#else
+#define RK_TRACE_SCOPE(name, buffer) do {} while (0)
+#define RK_TRACE_COUNTER(name, value) do {} while (0)
+#define RK_TRACE_DUMP() do {} while (0)
+#endif
+#endif
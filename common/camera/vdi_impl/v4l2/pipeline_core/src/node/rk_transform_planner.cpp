@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2024 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "rk_transform_planner.h"
+#include "camera.h"
+
+namespace OHOS::Camera {
+static constexpr uint64_t STATS_REPORT_INTERVAL = 300; // 300:frames between two reports of a stream
+
+static void LogStats(int32_t streamId, const RkTransformStats& stats)
+{
+    CAMERA_LOGI("RkTransformPlanner streamId[%{public}d]: %{public}llu frames, %{public}.2f RGA passes per frame, "
+        "%{public}llu passes eliminated, %{public}llu CPU copied bytes per frame", streamId,
+        static_cast<unsigned long long>(stats.frames),
+        stats.frames == 0 ? 0.0 : static_cast<double>(stats.passes) / stats.frames,
+        static_cast<unsigned long long>(stats.eliminated),
+        static_cast<unsigned long long>(stats.frames == 0 ? 0 : stats.cpuCopyBytes / stats.frames));
+}
+
+RkTransformPlanner& RkTransformPlanner::GetInstance()
+{
+    static RkTransformPlanner instance;
+    return instance;
+}
+
+void RkTransformPlanner::AddStage(int32_t streamId, RkTransformStage stage)
+{
+    std::lock_guard<std::mutex> l(lock_);
+    streams_[streamId].stages |= 1U << stage;
+}
+
+void RkTransformPlanner::RemoveStage(int32_t streamId, RkTransformStage stage)
+{
+    std::lock_guard<std::mutex> l(lock_);
+    auto it = streams_.find(streamId);
+    if (it == streams_.end()) {
+        return;
+    }
+    it->second.stages &= ~(1U << stage);
+    if (it->second.stages == 0) {
+        LogStats(streamId, it->second.stats);
+        streams_.erase(it);
+    }
+}
+
+bool RkTransformPlanner::RunsTransform(int32_t streamId, RkTransformStage stage)
+{
+    std::lock_guard<std::mutex> l(lock_);
+    auto it = streams_.find(streamId);
+    if (it == streams_.end()) {
+        // a node the planner was not told about keeps transforming on its own
+        return true;
+    }
+    Stream& stream = it->second;
+    if ((stream.stages >> (stage + 1)) != 0) {
+        stream.stats.eliminated++;
+        return false;
+    }
+    stream.stats.frames++;
+    if (stream.stats.frames % STATS_REPORT_INTERVAL == 0) {
+        LogStats(streamId, stream.stats);
+    }
+    return true;
+}
+
+void RkTransformPlanner::AddPasses(int32_t streamId, uint32_t passes, uint64_t cpuCopyBytes)
+{
+    std::lock_guard<std::mutex> l(lock_);
+    auto it = streams_.find(streamId);
+    if (it != streams_.end()) {
+        it->second.stats.passes += passes;
+        it->second.stats.cpuCopyBytes += cpuCopyBytes;
+    }
+}
+
+void RkTransformPlanner::AddCpuCopy(int32_t streamId, uint64_t bytes)
+{
+    std::lock_guard<std::mutex> l(lock_);
+    auto it = streams_.find(streamId);
+    if (it != streams_.end()) {
+        it->second.stats.cpuCopyBytes += bytes;
+    }
+}
+
+RkTransformStats RkTransformPlanner::GetStats(int32_t streamId)
+{
+    std::lock_guard<std::mutex> l(lock_);
+    auto it = streams_.find(streamId);
+    return it == streams_.end() ? RkTransformStats() : it->second.stats;
+}
+} // namespace OHOS::Camera
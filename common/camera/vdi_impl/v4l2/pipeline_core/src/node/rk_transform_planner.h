@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2024 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HOS_CAMERA_RK_TRANSFORM_PLANNER_H
+#define HOS_CAMERA_RK_TRANSFORM_PLANNER_H
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+
+namespace OHOS::Camera {
+// nodes of a stream that scale or convert frames with RGA, in the order frames pass them
+enum RkTransformStage : uint32_t {
+    RK_TRANSFORM_STAGE_SCALE = 0,   // RKScaleNode
+    RK_TRANSFORM_STAGE_CODEC,       // RKCodecNode, converts to the final or the encoder format
+    RK_TRANSFORM_STAGE_COUNT,
+};
+
+struct RkTransformStats {
+    uint64_t frames = 0;        // frames transformed by the last stage of the stream
+    uint64_t passes = 0;        // RGA jobs run for them, staging blits included
+    uint64_t eliminated = 0;    // transforms an earlier stage left to the last one
+    uint64_t cpuCopyBytes = 0;  // frame bytes moved by the CPU instead of RGA or a dma-buf handed on
+};
+
+/*
+ * Plans the RGA work of every stream. Each transforming node registers its stage when the stream
+ * starts, so the planner knows the chain a frame goes through. Consecutive scale and convert steps
+ * are collapsed into the last stage: it blits from what the sensor delivered straight to the format,
+ * size and rotation the frame leaves with, and the earlier stages pass the frame on untouched.
+ */
+class RkTransformPlanner {
+public:
+    static RkTransformPlanner& GetInstance();
+
+    void AddStage(int32_t streamId, RkTransformStage stage);
+    // logs the stats of the stream once its last stage is gone
+    void RemoveStage(int32_t streamId, RkTransformStage stage);
+    // called once per frame by a stage about to transform it, false when a later stage does it instead
+    bool RunsTransform(int32_t streamId, RkTransformStage stage);
+    void AddPasses(int32_t streamId, uint32_t passes, uint64_t cpuCopyBytes = 0);
+    void AddCpuCopy(int32_t streamId, uint64_t bytes);
+    RkTransformStats GetStats(int32_t streamId);
+
+private:
+    struct Stream {
+        uint32_t stages = 0;    // bit mask of the registered RkTransformStage
+        RkTransformStats stats;
+    };
+
+    std::mutex lock_;
+    std::map<int32_t, Stream> streams_;
+};
+} // namespace OHOS::Camera
+#endif
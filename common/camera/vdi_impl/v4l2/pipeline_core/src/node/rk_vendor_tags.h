@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2024 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HOS_CAMERA_RK_VENDOR_TAGS_H
+#define HOS_CAMERA_RK_VENDOR_TAGS_H
+
+#include <cstdint>
+
+namespace OHOS::Camera {
+// Board specific capture settings, carried in the vendor section of the capture metadata.
+enum RkVendorTag : uint32_t {
+    RK_VENDOR_TAG_START = 0x80000000,
+    RK_JPEG_ROTATION_MODE = RK_VENDOR_TAG_START, // uint8_t, RkJpegRotationMode
+    RK_FACE_DETECT_INTERVAL,                     // int32_t, analyse one preview frame out of this many
+    RK_VIDEO_RATE_CONTROL,                       // uint8_t, RkVideoRateControl of H.264 and H.265 streams
+    RK_VIDEO_BITRATE,                            // int32_t, bits per second with CBR and VBR
+    RK_VIDEO_GOP,                                // int32_t, frames from one key frame to the next
+    RK_VIDEO_QP,                                 // int32_t, QP of every frame with CQP
+    RK_VIDEO_REQUEST_IDR,                        // uint8_t, 1: the next encoded frame is a key frame
+    RK_JPEG_BURST,                               // uint8_t, 1: captures are encoded on several cores
+    RK_JPEG_ZSL,                                 // uint8_t, frames kept for zero shutter lag captures, 0: off
+    RK_VENDOR_TAG_END,
+};
+
+enum RkJpegRotationMode : uint8_t {
+    RK_JPEG_ROTATE_PIXELS = 0, // RGA rotates the frame before it is encoded
+    RK_JPEG_ROTATE_EXIF,       // the frame is encoded as captured, an EXIF Orientation tag tells the viewer
+};
+
+enum RkVideoRateControl : uint8_t {
+    RK_VIDEO_RC_VBR = 0,    // bitrate follows the scene, capped slightly above RK_VIDEO_BITRATE
+    RK_VIDEO_RC_CBR,        // bitrate held at RK_VIDEO_BITRATE
+    RK_VIDEO_RC_CQP,        // constant RK_VIDEO_QP, bitrate unbounded
+};
+} // namespace OHOS::Camera
+#endif
@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2024 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "rk_zsl_ring.h"
+#include <algorithm>
+#include <cstdlib>
+#include <ctime>
+#include "camera.h"
+#include "rk_node_utils.h"
+
+namespace OHOS::Camera {
+static constexpr int64_t TIME_CONVERSION_S_NS = 1000000000LL; /* s to ns */
+static constexpr size_t MAX_PENDING_SHUTTERS = 16; // 16:captures of repeating streams never pick a frame
+
+static int64_t GetMonotonicTimeNs()
+{
+    struct timespec ts = {};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * TIME_CONVERSION_S_NS + ts.tv_nsec;
+}
+
+RkZslCopy::RkZslCopy(std::shared_ptr<RkZslRing> ring, std::shared_ptr<RkZslFrame> slot, int64_t receivedNs,
+    RkRgaFence&& fence)
+    : ring_(ring), slot_(slot), receivedNs_(receivedNs), fence_(std::move(fence))
+{
+}
+
+RkZslCopy::~RkZslCopy()
+{
+    Wait();
+}
+
+void RkZslCopy::Wait()
+{
+    fence_.Wait();
+    if (ring_ != nullptr) {
+        ring_->Keep(slot_, receivedNs_);
+    }
+    ring_ = nullptr;
+    slot_ = nullptr;
+}
+
+RkZslRing::RkZslRing(uint32_t depth) : context_(std::make_shared<RkRgaContext>()), slots_(std::max(depth, 1U))
+{
+}
+
+void RkZslRing::SetCaptureSize(uint32_t width, uint32_t height)
+{
+    std::lock_guard<std::mutex> l(lock_);
+    if (width == captureWidth_ && height == captureHeight_) {
+        return;
+    }
+    // frames kept for another still stream may be smaller than this one, or nobody captures any more
+    ClearLocked();
+    captureWidth_ = width;
+    captureHeight_ = height;
+}
+
+RkZslCopy RkZslRing::Push(std::shared_ptr<IBuffer>& buffer)
+{
+    int32_t streamId = buffer->GetStreamId();
+    std::shared_ptr<RkZslFrame> slot = nullptr;
+    {
+        std::lock_guard<std::mutex> l(lock_);
+        if (captureWidth_ == 0 || captureHeight_ == 0 || (streamId_ >= 0 && streamId != streamId_) ||
+            buffer->GetCurWidth() < captureWidth_ || buffer->GetCurHeight() < captureHeight_) {
+            return RkZslCopy();
+        }
+        // the streams share one source path, the frames of the others would only be copied twice
+        streamId_ = streamId;
+        std::shared_ptr<RkZslFrame>& next = slots_[next_];
+        if (next == nullptr || next.use_count() > 1) {
+            // still held by a capture, it goes back to the pool once that capture is encoded
+            next = std::make_shared<RkZslFrame>();
+        }
+        next->receivedNs = 0;
+        slot = next;
+        next_ = (next_ + 1) % slots_.size();
+    }
+
+    int64_t receivedNs = GetMonotonicTimeNs();
+    RkRgaFence fence;
+    if (RkNodeUtils::BufferCopyFrameAsync(buffer, context_, slot->memory, slot->image, fence) != RC_OK) {
+        return RkZslCopy();
+    }
+    return RkZslCopy(shared_from_this(), slot, receivedNs, std::move(fence));
+}
+
+void RkZslRing::Keep(const std::shared_ptr<RkZslFrame>& slot, int64_t receivedNs)
+{
+    std::lock_guard<std::mutex> l(lock_);
+    // the ring may have been cleared while the frame was copied
+    if (std::find(slots_.begin(), slots_.end(), slot) != slots_.end()) {
+        slot->receivedNs = receivedNs;
+    }
+}
+
+void RkZslRing::Shutter(int32_t captureId)
+{
+    int64_t now = GetMonotonicTimeNs();
+    std::lock_guard<std::mutex> l(lock_);
+    shutterNs_[captureId] = now;
+    if (shutterNs_.size() > MAX_PENDING_SHUTTERS) {
+        shutterNs_.erase(shutterNs_.begin());
+    }
+}
+
+std::shared_ptr<const RkZslFrame> RkZslRing::Pick(int32_t captureId, uint32_t width, uint32_t height)
+{
+    int64_t shutterNs = GetMonotonicTimeNs();
+    std::lock_guard<std::mutex> l(lock_);
+    auto it = shutterNs_.find(captureId);
+    if (it != shutterNs_.end()) {
+        shutterNs = it->second;
+        shutterNs_.erase(it);
+    }
+    std::shared_ptr<RkZslFrame> best = nullptr;
+    for (const auto& slot : slots_) {
+        if (slot == nullptr || slot->receivedNs == 0 || slot->image.width < width || slot->image.height < height) {
+            continue;
+        }
+        if (best == nullptr || std::llabs(slot->receivedNs - shutterNs) < std::llabs(best->receivedNs - shutterNs)) {
+            best = slot;
+        }
+    }
+    return best;
+}
+
+void RkZslRing::Clear()
+{
+    std::lock_guard<std::mutex> l(lock_);
+    ClearLocked();
+    shutterNs_.clear();
+}
+
+void RkZslRing::ClearLocked()
+{
+    for (auto& slot : slots_) {
+        slot = nullptr;
+    }
+    next_ = 0;
+    streamId_ = -1;
+}
+} // namespace OHOS::Camera
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2024 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HOS_CAMERA_RK_ZSL_RING_H
+#define HOS_CAMERA_RK_ZSL_RING_H
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "ibuffer.h"
+#include "rk_blit_backend.h"
+#include "rk_buffer_pool.h"
+#include "rk_node_utils.h"
+
+namespace OHOS::Camera {
+struct RkZslFrame {
+    RkPoolBuffer memory;        // a dma-buf of the pool
+    RkBlitImage image = {};
+    int64_t receivedNs = 0;     // CLOCK_MONOTONIC, 0 until the copy has completed
+};
+
+class RkZslRing;
+
+// The RGA copy of one frame into the ring, the frame is kept once Wait() returns.
+// Like RkRgaFence it is waited on by the thread that pushed the frame.
+class RkZslCopy {
+public:
+    RkZslCopy() = default;
+    RkZslCopy(std::shared_ptr<RkZslRing> ring, std::shared_ptr<RkZslFrame> slot, int64_t receivedNs,
+        RkRgaFence&& fence);
+    RkZslCopy(RkZslCopy&& other) = default;
+    RkZslCopy& operator=(RkZslCopy&& other) = default;
+    ~RkZslCopy();
+    void Wait();
+
+private:
+    std::shared_ptr<RkZslRing> ring_ = nullptr;
+    std::shared_ptr<RkZslFrame> slot_ = nullptr;
+    int64_t receivedNs_ = 0;
+    RkRgaFence fence_;
+};
+
+/*
+ * Zero shutter lag: the last frames of a camera, kept at the size the source delivers them. While a
+ * still stream is configured, the frames of one stream at least as large as it are moved by RGA into
+ * dma-buf slots borrowed from the pool, on the ring's own RGA context so the copy runs next to the
+ * stream's own pass instead of before it. A capture takes a reference to the frame received closest
+ * to its shutter, the slot is left to it and replaced by a fresh one from the pool while the JPEG is encoded.
+ */
+class RkZslRing : public std::enable_shared_from_this<RkZslRing> {
+public:
+    explicit RkZslRing(uint32_t depth);
+
+    // size of the largest still stream, 0 x 0 while none is configured and nothing is kept
+    void SetCaptureSize(uint32_t width, uint32_t height);
+    // queues the copy of the frame, the buffer must not be written or handed on before it is waited on
+    RkZslCopy Push(std::shared_ptr<IBuffer>& buffer);
+    // called when the capture is requested, its frame arrives later
+    void Shutter(int32_t captureId);
+    // nullptr when no frame of at least width x height is kept, a capture without a shutter takes the newest
+    std::shared_ptr<const RkZslFrame> Pick(int32_t captureId, uint32_t width, uint32_t height);
+    void Clear();
+
+private:
+    friend class RkZslCopy;
+    void Keep(const std::shared_ptr<RkZslFrame>& slot, int64_t receivedNs);
+    void ClearLocked();
+
+    std::mutex lock_;
+    std::shared_ptr<RkRgaContext> context_ = nullptr;
+    std::vector<std::shared_ptr<RkZslFrame>> slots_;
+    uint32_t next_ = 0;
+    uint32_t captureWidth_ = 0;
+    uint32_t captureHeight_ = 0;
+    int32_t streamId_ = -1;     // the stream the ring is filled from, -1 until one at capture size delivers
+    std::map<int32_t, int64_t> shutterNs_;  // by capture id
+};
+} // namespace OHOS::Camera
+#endif
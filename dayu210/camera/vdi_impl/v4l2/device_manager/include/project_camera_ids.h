@@ -3,7 +3,9 @@
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
  * You may obtain a copy of the License at
+ *
  *     http://www.apache.org/licenses/LICENSE-2.0
+ *
  * Unless required by applicable law or agreed to in writing, software
  * distributed under the License is distributed on an "AS IS" BASIS,
  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
@@ -11,14 +13,19 @@
  * limitations under the License.
  */
 
-#ifndef __RK_NODE_UTILS_H__
-#define __RK_NODE_UTILS_H__
-#include "ibuffer.h"
+#ifndef HOS_CAMERA_PROJECT_CAMERA_IDS_H
+#define HOS_CAMERA_PROJECT_CAMERA_IDS_H
+
 namespace OHOS::Camera {
-    class RkNodeUtils {
-    public:
-        static void BufferScaleFormatTransform(std::shared_ptr<IBuffer>& buffer, bool flagToFd = true);
-    };
+// The logical camera ids of the host configuration and the sensor of project_hardware.h each one opens.
+struct LogicalCameraId {
+    const char* logicalId;
+    CameraId cameraId;
 };
 
-#endif
\ No newline at end of file
+static const LogicalCameraId LOGICAL_CAMERA_IDS[] = {
+    {"lcam001", CAMERA_FIRST},
+    {"lcam002", CAMERA_SECOND},
+};
+} // namespace OHOS::Camera
+#endif
@@ -14,13 +14,15 @@
 #ifndef HOS_CAMERA_RKEXIF_NODE_H
 #define HOS_CAMERA_RKEXIF_NODE_H
 
-#include <vector>
+#include <map>
+#include <memory>
 #include <condition_variable>
 #include <ctime>
 #include "device_manager_adapter.h"
 #include "utils.h"
 #include "camera.h"
 #include "source_node.h"
+#include "rk_exif_template.h"
 
 enum GpsIndex : int32_t {
     LATITUDE_INDEX = 0,
@@ -43,9 +45,13 @@ public:
 private:
     RetCode SendMetadata(std::shared_ptr<CameraMetadata> meta);
     RetCode SetGpsInfoMetadata(common_metadata_header_t *data);
+    void WriteExif(std::shared_ptr<IBuffer> &buffer);
 
     std::mutex gpsMetaDatalock_;
-    std::vector<double> gpsInfo_;
+    RkExifGps gps_ = {};        // latest fix only
+    bool hasGps_ = false;
+    std::mutex exifLock_;
+    std::map<int32_t, std::unique_ptr<RkExifTemplate>> exifTemplates_; // by stream id
 };
 } // namespace OHOS::Camera
 #endif
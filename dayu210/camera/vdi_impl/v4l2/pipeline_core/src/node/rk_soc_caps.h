@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2024 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HOS_CAMERA_RK_SOC_CAPS_H
+#define HOS_CAMERA_RK_SOC_CAPS_H
+
+#include "camera.h"
+#include "rk_mpi.h"
+extern "C" {
+#include "mpi_enc_utils.h"
+}
+
+namespace OHOS::Camera {
+// RK3588: the sensor delivers NV12, the MPP wrapper runs multi context, no JPEG encoder reachable through it.
+struct RkSocCaps {
+    static constexpr const char* NAME = "rk3588";
+
+    // NV12 goes to libjpeg and MPP as captured, no RGA pass is spent on repacking it
+    static constexpr bool RGA_YUV420P_OUTPUT = false;
+    static constexpr uint32_t JPEG_SOURCE_FORMAT = CAMERA_FORMAT_YCRCB_420_SP;
+    static constexpr uint32_t VIDEO_SOURCE_FORMAT = CAMERA_FORMAT_YCRCB_420_SP;
+    static constexpr MppFrameFormat VIDEO_MPP_FORMAT = MPP_FMT_YUV420SP;
+    // the frames of a stream V4L2SourceNodeRK has not negotiated are NV12 at the size of the buffer
+    static constexpr uint32_t SENSOR_FORMAT = CAMERA_FORMAT_YCRCB_420_SP;
+
+    static constexpr uint32_t ENCODER_CORES = 2; // 2:RKVENC cores, sessions encoded at the same time
+    static constexpr bool MPP_MULTI_CTX = true;
+    static constexpr bool JPEG_HW = false;
+    static constexpr uint32_t JPEG_BURST_WORKERS = 4; // 4:Cortex-A76 cores, burst shots encoded at the same time
+    static constexpr uint32_t DEFAULT_JPEG_ROTATION = 0; // clockwise degrees until the app asks otherwise
+
+    // the multi context wrapper keeps a pointer to its arguments, so every encoder gets its own copy of
+    // the defaults in mpi_enc_test_cmd_get() instead of the one block all contexts would share
+    static MpiEncTestArgs* GetEncArgs(MpiEncTestArgs& args)
+    {
+        MpiEncTestArgs* defaults = mpi_enc_test_cmd_get();
+        if (defaults == nullptr) {
+            return nullptr;
+        }
+        args = *defaults;
+        return &args;
+    }
+    static MpiEncTestData* GetEncData(void* halCtx)
+    {
+        return &static_cast<MpiEncMultiCtxInfo*>(halCtx)->ctx;
+    }
+};
+} // namespace OHOS::Camera
+#endif
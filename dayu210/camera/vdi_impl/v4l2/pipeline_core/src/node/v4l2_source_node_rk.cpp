@@ -13,6 +13,10 @@
 
 #include "v4l2_source_node_rk.h"
 #include "metadata_controller.h"
+#include "project_camera_ids.h"
+#include "rk_format_negotiator.h"
+#include "rk_soc_caps.h"
+#include "rk_trace.h"
 #include <unistd.h>
 
 namespace OHOS::Camera {
@@ -33,18 +37,74 @@ V4L2SourceNodeRK::V4L2SourceNodeRK(const std::string& name, const std::string& t
     }
 }
 
+static bool GetSensorCameraId(const std::string& cameraIds, CameraId& cameraId)
+{
+    for (const auto& it : LOGICAL_CAMERA_IDS) {
+        if (cameraIds == it.logicalId) {
+            cameraId = it.cameraId;
+            return true;
+        }
+    }
+    return false;
+}
+
 RetCode V4L2SourceNodeRK::GetDeviceController()
 {
     CameraId cameraId = CAMERA_FIRST;
+    if (!GetSensorCameraId(cameraIds_, cameraId)) {
+        CAMERA_LOGE("camera %{public}s is not in project_camera_ids.h, no sensor to open", cameraIds_.c_str());
+        return RC_ERROR;
+    }
     sensorController_ = std::static_pointer_cast<SensorController>
         (deviceManager_->GetController(cameraId, DM_M_SENSOR, DM_C_SENSOR));
     if (sensorController_ == nullptr) {
-        CAMERA_LOGE("get device controller failed");
+        CAMERA_LOGE("get device controller of %{public}s (%{public}d) failed", cameraIds_.c_str(), cameraId);
         return RC_ERROR;
     }
     return RC_OK;
 }
 
+struct RkV4l2Format {
+    uint32_t pixelFormat;
+    uint32_t cameraFormat;
+};
+
+// what the ISP main and self path can write that RGA and the encoders read, in order of preference
+static const RkV4l2Format SOURCE_FORMATS[] = {
+    {V4L2_PIX_FMT_NV12, CAMERA_FORMAT_YCRCB_420_SP},
+    {V4L2_PIX_FMT_YUV420, CAMERA_FORMAT_YCRCB_420_P},
+};
+
+static uint32_t GetPixelFormat(uint32_t cameraFormat)
+{
+    for (const auto& format : SOURCE_FORMATS) {
+        if (format.cameraFormat == cameraFormat) {
+            return format.pixelFormat;
+        }
+    }
+    return V4L2_PIX_FMT_NV12;
+}
+
+// JPEG streams are encoded from the libjpeg source format, every other stream wants its own format
+static RkSourcePlan NegotiateSourcePlan(const std::vector<std::shared_ptr<IPort>>& outPorts)
+{
+    std::vector<RkStreamDemand> demands;
+    for (const auto& it : outPorts) {
+        RkStreamDemand demand;
+        demand.streamId = static_cast<int32_t>(it->format_.streamId_);
+        demand.width = static_cast<uint32_t>(it->format_.w_);
+        demand.height = static_cast<uint32_t>(it->format_.h_);
+        demand.format = it->format_.format_ == CAMERA_FORMAT_BLOB ? RkSocCaps::JPEG_SOURCE_FORMAT :
+            static_cast<uint32_t>(it->format_.format_);
+        demands.push_back(demand);
+    }
+    std::vector<uint32_t> candidates;
+    for (const auto& format : SOURCE_FORMATS) {
+        candidates.push_back(format.cameraFormat);
+    }
+    return RkFormatNegotiator::Negotiate(demands, candidates);
+}
+
 RetCode V4L2SourceNodeRK::Init(const int32_t streamId)
 {
     return RC_OK;
@@ -64,11 +124,15 @@ RetCode V4L2SourceNodeRK::Start(const int32_t streamId)
         return RC_ERROR;
     }
     std::vector<std::shared_ptr<IPort>> outPorts = GetOutPorts();
+    RkSourcePlan plan = NegotiateSourcePlan(outPorts);
+    RkFormatNegotiator::GetInstance().SetPlan(cameraIds_, plan);
+    // the ports share the one ISP path of the device, every port starts it with the same format and size
     for (const auto& it : outPorts) {
+        const RkSourcePath& path = plan.paths[static_cast<int32_t>(it->format_.streamId_)];
         DeviceFormat format;
-        format.fmtdesc.pixelformat =  V4L2_PIX_FMT_NV12;
-        format.fmtdesc.width = it->format_.w_;
-        format.fmtdesc.height = it->format_.h_;
+        format.fmtdesc.pixelformat = GetPixelFormat(path.format);
+        format.fmtdesc.width = path.width;
+        format.fmtdesc.height = path.height;
         int bufCnt = it->format_.bufferCount_;
         rc = sensorController_->Start(bufCnt, format);
         if (rc == RC_ERROR) {
@@ -106,6 +170,7 @@ RetCode V4L2SourceNodeRK::Stop(const int32_t streamId)
         rc = sensorController_->Stop();
         CHECK_IF_NOT_EQUAL_RETURN_VALUE(rc, RC_OK, RC_ERROR);
     }
+    RkFormatNegotiator::GetInstance().ClearPlan(cameraIds_);
 
     return SourceNode::Stop(streamId);
 }
@@ -154,6 +219,7 @@ void V4L2SourceNodeRK::OnMetadataChanged(const std::shared_ptr<CameraMetadata>&
 void V4L2SourceNodeRK::SetBufferCallback()
 {
     sensorController_->SetNodeCallBack([&](std::shared_ptr<FrameSpec> frameSpec) {
+            RK_TRACE_SCOPE("V4L2SourceNodeRK", frameSpec->buffer_);
             OnPackBuffer(frameSpec);
     });
     return;
@@ -161,9 +227,9 @@ void V4L2SourceNodeRK::SetBufferCallback()
 
 RetCode V4L2SourceNodeRK::ProvideBuffers(std::shared_ptr<FrameSpec> frameSpec)
 {
-    CAMERA_LOGI("provide buffers enter.");
+    CAMERA_LOGD("provide buffers enter.");
     if (sensorController_->SendFrameBuffer(frameSpec) == RC_OK) {
-        CAMERA_LOGI("sendframebuffer success bufferpool id = %llu", frameSpec->bufferPoolId_);
+        CAMERA_LOGD("sendframebuffer success bufferpool id = %llu", frameSpec->bufferPoolId_);
         return RC_OK;
     }
     return RC_ERROR;
@@ -12,8 +12,9 @@
  */
 
 #include "rk_exif_node.h"
-#include <exif_utils.h>
 #include <securec.h>
+#include "rk_dump_writer.h"
+#include "rk_trace.h"
 #include "camera_dump.h"
 
 namespace OHOS::Camera {
@@ -37,6 +38,8 @@ RetCode RKExifNode::Start(const int32_t streamId)
 RetCode RKExifNode::Stop(const int32_t streamId)
 {
     CAMERA_LOGI("RKExifNode::Stop streamId = %{public}d\n", streamId);
+    std::lock_guard<std::mutex> l(exifLock_);
+    exifTemplates_.erase(streamId);
     return RC_OK;
 }
 
@@ -52,31 +55,53 @@ void RKExifNode::DeliverBuffer(std::shared_ptr<IBuffer> &buffer)
         CAMERA_LOGE("RKExifNode::DeliverBuffer frameSpec is null");
         return;
     }
+    RK_TRACE_SCOPE("RKExifNode", buffer);
 
     int32_t id = buffer->GetStreamId();
-    CAMERA_LOGE("RKExifNode::DeliverBuffer StreamId %{public}d", id);
-    if (buffer->GetEncodeType() == ENCODE_TYPE_JPEG && gpsInfo_.size() > 0) {
-        int outPutBufferSize = 0;
-        exif_data exifInfo;
-        exifInfo.latitude = gpsInfo_.at(LATITUDE_INDEX);
-        exifInfo.longitude = gpsInfo_.at(LONGITUDE_INDEX);
-        exifInfo.altitude = gpsInfo_.at(ALTITUDE_INDEX);
-        EsFrameInfo info = buffer->GetEsFrameInfo();
-        CAMERA_LOGI("%{public}s info.size = (%{public}d)\n", __FUNCTION__, info.size);
-        if (info.size != -1) {
-            exifInfo.frame_size = info.size;
-            ExifUtils::AddCustomExifInfo(exifInfo, buffer->GetVirAddress(), outPutBufferSize);
-            CAMERA_LOGI("%{public}s virAddress(%{public}p) and outPutBufferSize = (%{public}d)\n",
-                __FUNCTION__, buffer->GetVirAddress(), outPutBufferSize);
-            buffer->SetEsFrameSize(outPutBufferSize);
-        }
+    CAMERA_LOGD("RKExifNode::DeliverBuffer StreamId %{public}d", id);
+    if (buffer->GetEncodeType() == ENCODE_TYPE_JPEG) {
+        WriteExif(buffer);
     }
 
-    CameraDumper& dumper = CameraDumper::GetInstance();
-    dumper.DumpBuffer("board_RKExifNode", ENABLE_RKEXIF_NODE_CONVERTED, buffer);
+    RkDumpWriter::GetInstance().Dump("board_RKExifNode", ENABLE_RKEXIF_NODE_CONVERTED, buffer);
     NodeBase::DeliverBuffer(buffer);
 }
 
+void RKExifNode::WriteExif(std::shared_ptr<IBuffer> &buffer)
+{
+    EsFrameInfo info = buffer->GetEsFrameInfo();
+    bool inSurface = buffer->GetIsValidDataInSurfaceBuffer();
+    uint8_t *jpeg = static_cast<uint8_t *>(inSurface ? buffer->GetSuffaceBufferAddr() : buffer->GetVirAddress());
+    size_t capacity = inSurface ? buffer->GetSuffaceBufferSize() : buffer->GetSize();
+    if (jpeg == nullptr || info.size <= 0 || static_cast<size_t>(info.size) > capacity) {
+        return;
+    }
+
+    RkExifGps gps = {};
+    bool hasGps = false;
+    {
+        std::lock_guard<std::mutex> l(gpsMetaDatalock_);
+        gps = gps_;
+        hasGps = hasGps_;
+    }
+    std::lock_guard<std::mutex> l(exifLock_);
+    std::unique_ptr<RkExifTemplate> &exif = exifTemplates_[buffer->GetStreamId()];
+    if (exif == nullptr || exif->HasGps() != hasGps) {
+        exif = std::make_unique<RkExifTemplate>(hasGps);
+    }
+    exif->SetGps(gps);
+    // the codec node tags a frame it left to the viewer to rotate, keep that
+    uint16_t orientation = RkExifTemplate::ReadOrientation(jpeg, info.size);
+    exif->SetOrientation(orientation != 0 ? orientation : 1);
+    exif->SetDateTime(time(nullptr));
+    size_t size = exif->Splice(jpeg, info.size, capacity);
+    if (size == 0) {
+        CAMERA_LOGE("RKExifNode::WriteExif no room for EXIF, jpeg size %{public}d", info.size);
+        return;
+    }
+    buffer->SetEsFrameSize(size);
+}
+
 RetCode RKExifNode::Config(const int32_t streamId, const CaptureMeta &meta)
 {
     if (meta == nullptr) {
@@ -148,10 +173,9 @@ RetCode RKExifNode::SetGpsInfoMetadata(common_metadata_header_t *data)
         return RC_ERROR;
     }
 
-    for (int i = 0; i < count; i++) {
-        std::lock_guard<std::mutex> l(gpsMetaDatalock_);
-        gpsInfo_.push_back(*(entry.data.d + i));
-    }
+    std::lock_guard<std::mutex> l(gpsMetaDatalock_);
+    gps_ = {entry.data.d[LATITUDE_INDEX], entry.data.d[LONGITUDE_INDEX], entry.data.d[ALTITUDE_INDEX]};
+    hasGps_ = true;
     return RC_OK;
 }
 
@@ -13,6 +13,12 @@
 
 #include "rk_face_node.h"
 #include <securec.h>
+#include <algorithm>
+#include "rk_format_negotiator.h"
+#include "rk_soc_caps.h"
+#include "rk_dump_writer.h"
+#include "rk_trace.h"
+#include "rk_vendor_tags.h"
 #include "camera_dump.h"
 
 namespace OHOS::Camera {
@@ -31,12 +37,18 @@ RetCode RKFaceNode::Start(const int32_t streamId)
 {
     CAMERA_LOGI("RKFaceNode::Start streamId = %{public}d\n", streamId);
     CreateMetadataInfo();
+    started_ = true;
+    if (faceDetectEnabled_) {
+        detector_.Start();
+    }
     return RC_OK;
 }
 
 RetCode RKFaceNode::Stop(const int32_t streamId)
 {
     CAMERA_LOGI("RKFaceNode::Stop streamId = %{public}d\n", streamId);
+    started_ = false;
+    detector_.Stop();
     std::unique_lock <std::mutex> lock(mLock_);
     metaDataSize_ = 0;
     return RC_OK;
@@ -54,18 +66,80 @@ void RKFaceNode::DeliverBuffer(std::shared_ptr<IBuffer>& buffer)
         CAMERA_LOGE("RKFaceNode::DeliverBuffer frameSpec is null");
         return;
     }
+    RK_TRACE_SCOPE("RKFaceNode", buffer);
+
+    DetectFaces(buffer);
 
-    CameraDumper& dumper = CameraDumper::GetInstance();
-    dumper.DumpBuffer("board_RKFaceNode", ENABLE_RKFACE_NODE_CONVERTED, buffer);
+    RkDumpWriter::GetInstance().Dump("board_RKFaceNode", ENABLE_RKFACE_NODE_CONVERTED, buffer);
     NodeBase::DeliverBuffer(buffer);
 }
 
 RetCode RKFaceNode::Config(const int32_t streamId, const CaptureMeta& meta)
 {
-    (void)meta;
+    if (meta == nullptr || meta->get() == nullptr) {
+        CAMERA_LOGD("RKFaceNode::Config no capture settings");
+        return RC_OK;
+    }
+    return ConfigFaceDetect(meta->get());
+}
+
+RetCode RKFaceNode::ConfigFaceDetect(common_metadata_header_t* data)
+{
+    camera_metadata_item_t entry;
+    int ret = FindCameraMetadataItem(data, OHOS_STATISTICS_FACE_DETECT_SWITCH, &entry);
+    if (ret == 0 && entry.data.u8 != nullptr) {
+        faceDetectEnabled_ = *entry.data.u8 != OHOS_CAMERA_FACE_DETECT_MODE_OFF;
+        CAMERA_LOGI("OHOS_STATISTICS_FACE_DETECT_SWITCH is = %{public}u", *entry.data.u8);
+    }
+    ret = FindCameraMetadataItem(data, RK_FACE_DETECT_INTERVAL, &entry);
+    if (ret == 0 && entry.data.i32 != nullptr) {
+        detector_.SetInterval(std::max(*entry.data.i32, 0));
+        CAMERA_LOGI("RK_FACE_DETECT_INTERVAL is = %{public}d", *entry.data.i32);
+    }
+
+    if (!faceDetectEnabled_) {
+        detector_.Stop();
+    } else if (started_) {
+        detector_.Start();
+    }
     return RC_OK;
 }
 
+void RKFaceNode::DetectFaces(std::shared_ptr<IBuffer>& buffer)
+{
+    if (faceDetectEnabled_ && buffer->GetBufferStatus() == CAMERA_BUFFER_STATUS_OK) {
+        uint32_t format = buffer->GetCurFormat();
+        uint32_t width = buffer->GetCurWidth();
+        uint32_t height = buffer->GetCurHeight();
+        RkSourcePath path;
+        if (RkFormatNegotiator::GetInstance().GetPath(buffer->GetStreamId(), path)) {
+            format = path.format;
+            width = path.width;
+            height = path.height;
+        } else if constexpr (RkSocCaps::SENSOR_FORMAT != 0) {
+            format = RkSocCaps::SENSOR_FORMAT;
+            width = buffer->GetWidth();
+            height = buffer->GetHeight();
+        }
+        void* data = buffer->GetIsValidDataInSurfaceBuffer() ? buffer->GetSuffaceBufferAddr() :
+            buffer->GetVirAddress();
+        // samples the frame and returns, the analysis runs on the detector thread
+        detector_.Submit(static_cast<const uint8_t*>(data), width, height, format);
+    }
+
+    std::vector<RkFaceRect> faces;
+    uint64_t generation = detector_.GetFaces(faces);
+    if (generation == faceGeneration_) {
+        return;
+    }
+    faceGeneration_ = generation;
+    {
+        std::unique_lock <std::mutex> lock(mLock_);
+        faces_.swap(faces);
+    }
+    CreateMetadataInfo();
+}
+
 RetCode RKFaceNode::Capture(const int32_t streamId, const int32_t captureId)
 {
     CAMERA_LOGV("RKFaceNode::Capture");
@@ -88,59 +162,38 @@ RetCode RKFaceNode::GetFaceDetectMetaData(std::shared_ptr<CameraMetadata> &metad
 
 RetCode RKFaceNode::GetCameraFaceDetectSwitch(std::shared_ptr<CameraMetadata> &metadata)
 {
-    uint8_t faceDetectSwitch = OHOS_CAMERA_FACE_DETECT_MODE_SIMPLE;
+    uint8_t faceDetectSwitch = faceDetectEnabled_ ? OHOS_CAMERA_FACE_DETECT_MODE_SIMPLE :
+        OHOS_CAMERA_FACE_DETECT_MODE_OFF;
     metadata->addEntry(OHOS_STATISTICS_FACE_DETECT_SWITCH, &faceDetectSwitch, sizeof(uint8_t));
     return RC_OK;
 }
 
 RetCode RKFaceNode::GetCameraFaceRectangles(std::shared_ptr<CameraMetadata> &metadata)
 {
-    constexpr int32_t row = 3;
-    constexpr int32_t col = 4;
-    constexpr float rect_one_x = 0.0; // dummy data: faceRectangles data
-    constexpr float rect_one_y = 0.0;
-    constexpr float rect_one_width = 0.2;
-    constexpr float rect_one_height = 0.3;
-
-    constexpr float rect_two_x = 0.3; // dummy data: faceRectangles data
-    constexpr float rect_two_y = 0.3;
-    constexpr float rect_two_width = 0.2;
-    constexpr float rect_two_height = 0.3;
-
-    constexpr float rect_three_x = 0.6; // dummy data: faceRectangles data
-    constexpr float rect_three_y = 0.6;
-    constexpr float rect_three_width = 0.2;
-    constexpr float rect_three_height = 0.3;
-
-    float faceRectangles[row][col];
-    faceRectangles[INDEX_0][INDEX_0] = rect_one_x;
-    faceRectangles[INDEX_0][INDEX_1] = rect_one_y;
-    faceRectangles[INDEX_0][INDEX_2] = rect_one_width;
-    faceRectangles[INDEX_0][INDEX_3] = rect_one_height;
-
-    faceRectangles[INDEX_1][INDEX_0] = rect_two_x;
-    faceRectangles[INDEX_1][INDEX_1] = rect_two_y;
-    faceRectangles[INDEX_1][INDEX_2] = rect_two_width;
-    faceRectangles[INDEX_1][INDEX_3] = rect_two_height;
-
-    faceRectangles[INDEX_2][INDEX_0] = rect_three_x;
-    faceRectangles[INDEX_2][INDEX_1] = rect_three_y;
-    faceRectangles[INDEX_2][INDEX_2] = rect_three_width;
-    faceRectangles[INDEX_2][INDEX_3] = rect_three_height;
-    metadata->addEntry(OHOS_STATISTICS_FACE_RECTANGLES, static_cast<void*>(&faceRectangles[0]),
-        row * col);
+    if (faces_.empty()) {
+        return RC_OK;
+    }
+    // x, y, width and height of every face as fractions of the frame
+    std::vector<float> faceRectangles;
+    for (auto& face : faces_) {
+        faceRectangles.push_back(face.x);
+        faceRectangles.push_back(face.y);
+        faceRectangles.push_back(face.width);
+        faceRectangles.push_back(face.height);
+    }
+    metadata->addEntry(OHOS_STATISTICS_FACE_RECTANGLES, faceRectangles.data(), faceRectangles.size());
     return RC_OK;
 }
 
 RetCode RKFaceNode::GetCameraFaceIds(std::shared_ptr<CameraMetadata> &metadata)
 {
+    if (faces_.empty()) {
+        return RC_OK;
+    }
     std::vector<int32_t> vFaceIds;
-    constexpr int32_t id_zero = 0;
-    constexpr int32_t id_one = 1;
-    constexpr int32_t id_two = 2;
-    vFaceIds.push_back(id_zero);
-    vFaceIds.push_back(id_one);
-    vFaceIds.push_back(id_two);
+    for (auto& face : faces_) {
+        vFaceIds.push_back(face.id);
+    }
     metadata->addEntry(OHOS_STATISTICS_FACE_IDS, vFaceIds.data(), vFaceIds.size());
     return RC_OK;
 }
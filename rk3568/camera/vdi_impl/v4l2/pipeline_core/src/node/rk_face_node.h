@@ -21,13 +21,7 @@
 #include "utils.h"
 #include "camera.h"
 #include "source_node.h"
-
-enum FaceRectanglesIndex : int32_t {
-    INDEX_0 = 0,
-    INDEX_1,
-    INDEX_2,
-    INDEX_3,
-};
+#include "rk_face_detector.h"
 
 namespace OHOS::Camera {
 std::vector<uint32_t> FaceDetectMetadataTag = {
@@ -57,6 +51,8 @@ private:
     RetCode CopyMetadataBuffer(std::shared_ptr<CameraMetadata> &metadata,
         std::shared_ptr<IBuffer>& outPutBuffer, int32_t dataSize);
     RetCode CreateMetadataInfo();
+    RetCode ConfigFaceDetect(common_metadata_header_t* data);
+    void DetectFaces(std::shared_ptr<IBuffer>& buffer);
 
 private:
     std::vector<std::shared_ptr<IPort>> outPutPorts_;
@@ -64,6 +60,11 @@ private:
     std::shared_ptr<CameraMetadata> metaData_ = nullptr;
     std::condition_variable cv_;
     int32_t metaDataSize_;
+    RkFaceDetector detector_;
+    std::vector<RkFaceRect> faces_;
+    uint64_t faceGeneration_ = 0;
+    bool faceDetectEnabled_ = true;
+    bool started_ = false;
 };
 } // namespace OHOS::Camera
 #endif
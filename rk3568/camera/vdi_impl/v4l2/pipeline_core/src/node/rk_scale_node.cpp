@@ -13,6 +13,8 @@
 
 #include "rk_scale_node.h"
 #include "rk_node_utils.h"
+#include "rk_trace.h"
+#include "rk_transform_planner.h"
 #include <securec.h>
 #include "cstdint"
 #include "memory"
@@ -31,12 +33,15 @@ RKScaleNode::~RKScaleNode()
 RetCode RKScaleNode::Start(const int32_t streamId)
 {
     CAMERA_LOGI("RKScaleNode::Start streamId = %{public}d\n", streamId);
+    RkTransformPlanner::GetInstance().AddStage(streamId, RK_TRANSFORM_STAGE_SCALE);
     return RC_OK;
 }
 
 RetCode RKScaleNode::Stop(const int32_t streamId)
 {
     CAMERA_LOGI("RKScaleNode::Stop streamId = %{public}d\n", streamId);
+    RkNodeUtils::ReleaseRgaContext(streamId);
+    RkTransformPlanner::GetInstance().RemoveStage(streamId, RK_TRANSFORM_STAGE_SCALE);
     return RC_OK;
 }
 
@@ -52,6 +57,7 @@ void RKScaleNode::DeliverBuffer(std::shared_ptr<IBuffer>& buffer)
         CAMERA_LOGE("RKScaleNode::DeliverBuffer frameSpec is null");
         return;
     }
+    RK_TRACE_SCOPE("RKScaleNode", buffer);
 
     if (buffer->GetBufferStatus() != CAMERA_BUFFER_STATUS_OK) {
         CAMERA_LOGE("BufferStatus() != CAMERA_BUFFER_STATUS_OK");
@@ -59,13 +65,15 @@ void RKScaleNode::DeliverBuffer(std::shared_ptr<IBuffer>& buffer)
     }
 
     int32_t id = buffer->GetStreamId();
-    CAMERA_LOGI("RKScaleNode::DeliverBuffer, streamId[%{public}d],\
+    CAMERA_LOGD("RKScaleNode::DeliverBuffer, streamId[%{public}d],\
 index[%{public}d], %{public}d * %{public}d ==> %{public}d * %{public}d, encodeType = %{public}d",
         buffer->GetStreamId(), buffer->GetIndex(),
         buffer->GetCurWidth(), buffer->GetCurHeight(), buffer->GetWidth(), buffer->GetHeight(),
         buffer->GetEncodeType());
 
-    if (buffer->GetEncodeType() == ENCODE_TYPE_NULL) {
+    // when RKCodecNode follows on the stream it scales and converts in the same pass, the frame goes on as is
+    if (buffer->GetEncodeType() == ENCODE_TYPE_NULL &&
+        RkTransformPlanner::GetInstance().RunsTransform(id, RK_TRANSFORM_STAGE_SCALE)) {
         RkNodeUtils::BufferScaleFormatTransform(buffer);
     }
     NodeBase::DeliverBuffer(buffer);
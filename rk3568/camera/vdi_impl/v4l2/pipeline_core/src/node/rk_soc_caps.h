@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2024 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HOS_CAMERA_RK_SOC_CAPS_H
+#define HOS_CAMERA_RK_SOC_CAPS_H
+
+#include "camera.h"
+#include "rk_mpi.h"
+extern "C" {
+#include "mpi_enc_utils.h"
+}
+
+namespace OHOS::Camera {
+// RK3568: RGA2, single context MPP wrapper, no JPEG encoder reachable through the wrapper.
+struct RkSocCaps {
+    static constexpr const char* NAME = "rk3568";
+
+    // RGA2 writes planar I420, which libjpeg and MPP consume without any repacking
+    static constexpr bool RGA_YUV420P_OUTPUT = true;
+    static constexpr uint32_t JPEG_SOURCE_FORMAT = CAMERA_FORMAT_YCRCB_420_P;
+    static constexpr uint32_t VIDEO_SOURCE_FORMAT = CAMERA_FORMAT_YCRCB_420_P;
+    static constexpr MppFrameFormat VIDEO_MPP_FORMAT = MPP_FMT_YUV420P;
+    // 0: the source node reports the sensor format of every buffer itself
+    static constexpr uint32_t SENSOR_FORMAT = 0;
+
+    static constexpr uint32_t ENCODER_CORES = 1; // 1:RKVENC core, sessions encoded at the same time
+    static constexpr bool MPP_MULTI_CTX = false;
+    static constexpr bool JPEG_HW = false;
+    static constexpr uint32_t JPEG_BURST_WORKERS = 4; // 4:Cortex-A55 cores, burst shots encoded at the same time
+    static constexpr uint32_t DEFAULT_JPEG_ROTATION = 270; // clockwise degrees until the app asks otherwise
+
+    static MpiEncTestArgs* GetEncArgs(MpiEncTestArgs& args)
+    {
+        return &args;
+    }
+    static MpiEncTestData* GetEncData(void* halCtx)
+    {
+        return static_cast<MpiEncTestData*>(halCtx);
+    }
+};
+} // namespace OHOS::Camera
+#endif